@@ -0,0 +1,251 @@
+#include "CommandStats.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+namespace {
+
+qint64 timevalToUs(const timeval &value)
+{
+    return qint64(value.tv_sec) * 1000000 + value.tv_usec;
+}
+
+qint64 childCpuUs()
+{
+    rusage usage;
+    if (getrusage(RUSAGE_CHILDREN, &usage) != 0)
+    {
+        return 0;
+    }
+    return timevalToUs(usage.ru_utime) + timevalToUs(usage.ru_stime);
+}
+
+} // namespace
+
+CommandStats *CommandStats::instance()
+{
+    static CommandStats *stats = []() {
+        // The first command may well be reaped on a worker thread, the object
+        // still belongs to the GUI thread and is parented to the application there
+        CommandStats *created = new CommandStats();
+        created->moveToThread(qApp->thread());
+        QMetaObject::invokeMethod(qApp, [created]() {
+            created->setParent(qApp);
+        });
+        return created;
+    }();
+    return stats;
+}
+
+CommandStats::CommandStats(QObject *parent)
+    : QObject(parent),
+    lastChildCpuUs(childCpuUs())
+{
+    // Keep the numbers of the last session even if nobody opened the overlay
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        dump();
+    });
+}
+
+QString CommandStats::commandKey(const QString &program, const QStringList &arguments)
+{
+    QString name = QFileInfo(program).fileName();
+
+    // For shell pipelines the first word of the script says what actually ran
+    if ((name == "sh" || name == "bash") && arguments.size() >= 2 && arguments.at(0) == "-c")
+    {
+        return name + " " + arguments.at(1).section(' ', 0, 0, QString::SectionSkipEmpty);
+    }
+
+    // Otherwise the first argument that is not an option, e.g. the nmcli object
+    for (const QString &argument : arguments)
+    {
+        if (!argument.startsWith('-'))
+        {
+            return name + " " + argument;
+        }
+    }
+    return name;
+}
+
+void CommandStats::record(const QString &command, qint64 wallUs, int exitCode, qint64 outputBytes)
+{
+    QMutexLocker locker(&mutex);
+
+    Entry &entry = entries[command];
+    ++entry.spawns;
+    if (exitCode < 0)
+    {
+        ++entry.failures;
+    }
+    entry.totalWallUs += wallUs;
+    entry.maxWallUs = qMax(entry.maxWallUs, wallUs);
+    entry.totalCpuUs += takeChildCpuUs();
+    entry.totalOutputBytes += outputBytes;
+    entry.lastExitCode = exitCode;
+    ++entry.histogram[bucketFor(wallUs)];
+}
+
+void CommandStats::recordDetached(const QString &command, bool started)
+{
+    QMutexLocker locker(&mutex);
+
+    Entry &entry = entries[command];
+    ++entry.spawns;
+    if (!started)
+    {
+        ++entry.failures;
+        entry.lastExitCode = -1;
+    }
+}
+
+QHash<QString, CommandStats::Entry> CommandStats::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+    return entries;
+}
+
+QStringList CommandStats::summaryLines() const
+{
+    const QHash<QString, Entry> current = snapshot();
+
+    QStringList commands = current.keys();
+    std::sort(commands.begin(), commands.end(), [&current](const QString &a, const QString &b) {
+        return current.value(a).totalWallUs > current.value(b).totalWallUs;
+    });
+
+    QStringList lines;
+    for (const QString &command : std::as_const(commands))
+    {
+        const Entry &entry = current[command];
+        const quint64 timed = qMax<quint64>(1, entry.spawns);
+        lines.append(QString("%1: %2 runs, %3 failed, p50 %4 ms, p95 %5 ms, max %6 ms, cpu %7 ms/run, %8 B/run, exit %9")
+                         .arg(command)
+                         .arg(entry.spawns)
+                         .arg(entry.failures)
+                         .arg(percentileMs(entry, 0.5))
+                         .arg(percentileMs(entry, 0.95))
+                         .arg(entry.maxWallUs / 1000)
+                         .arg(double(entry.totalCpuUs) / timed / 1000.0, 0, 'f', 1)
+                         .arg(entry.totalOutputBytes / qint64(timed))
+                         .arg(entry.lastExitCode));
+    }
+    if (lines.isEmpty())
+    {
+        lines.append("No commands run yet");
+    }
+    return lines;
+}
+
+QString CommandStats::defaultDumpPath()
+{
+    QString path = qEnvironmentVariable("HOMESCREEN_COMMAND_STATS");
+    if (path.isEmpty())
+    {
+        path = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/command-stats.json";
+    }
+    return path;
+}
+
+bool CommandStats::dump(const QString &path) const
+{
+    const QString target = path.isEmpty() ? defaultDumpPath() : path;
+    const QHash<QString, Entry> current = snapshot();
+
+    QJsonObject commands;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it)
+    {
+        const Entry &entry = it.value();
+
+        QJsonArray histogram;
+        for (int i = 0; i < HistogramBuckets; ++i)
+        {
+            histogram.append(qint64(entry.histogram[i]));
+        }
+
+        QJsonObject object;
+        object["spawns"] = qint64(entry.spawns);
+        object["failures"] = qint64(entry.failures);
+        object["totalWallUs"] = entry.totalWallUs;
+        object["maxWallUs"] = entry.maxWallUs;
+        object["totalCpuUs"] = entry.totalCpuUs;
+        object["totalOutputBytes"] = entry.totalOutputBytes;
+        object["lastExitCode"] = entry.lastExitCode;
+        object["wallHistogramLog2Ms"] = histogram;
+        commands[it.key()] = object;
+    }
+
+    QJsonObject root;
+    root["version"] = QCoreApplication::applicationVersion();
+    root["commands"] = commands;
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Failed to write command stats to" << target << ":" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
+
+qint64 CommandStats::takeChildCpuUs()
+{
+    // RUSAGE_CHILDREN only grows once a child is reaped, so the delta since the
+    // last record belongs to the command just reaped. Two commands reaped at the
+    // same moment share one delta, which is close enough for spotting regressions.
+    const qint64 now = childCpuUs();
+    const qint64 delta = qMax<qint64>(0, now - lastChildCpuUs);
+    lastChildCpuUs = now;
+    return delta;
+}
+
+int CommandStats::bucketFor(qint64 wallUs)
+{
+    qint64 ms = wallUs / 1000;
+    int bucket = 0;
+    while (ms > 0 && bucket < HistogramBuckets - 1)
+    {
+        ms >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+qint64 CommandStats::percentileMs(const Entry &entry, double fraction)
+{
+    quint64 total = 0;
+    for (int i = 0; i < HistogramBuckets; ++i)
+    {
+        total += entry.histogram[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Report the upper edge of the bucket holding the percentile
+    const quint64 rank = quint64(fraction * double(total - 1)) + 1;
+    quint64 seen = 0;
+    for (int i = 0; i < HistogramBuckets; ++i)
+    {
+        seen += entry.histogram[i];
+        if (seen >= rank)
+        {
+            return qint64(1) << i;
+        }
+    }
+    return qint64(1) << (HistogramBuckets - 1);
+}
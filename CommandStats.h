@@ -0,0 +1,69 @@
+#ifndef COMMANDSTATS_H
+#define COMMANDSTATS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// Records every external command the panel runs: how often it was spawned, how
+// long it took, how much CPU it used, how it exited and how much it printed.
+// Wall times are also kept as log2 histograms per command. Safe to call from
+// worker threads.
+class CommandStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Bucket 0 holds runs under 1 ms, bucket i runs of [2^(i-1), 2^i) ms, the last one everything slower
+    static const int HistogramBuckets = 16;
+
+    struct Entry
+    {
+        quint64 spawns = 0;
+        quint64 failures = 0;        // failed to start, crashed or timed out
+        qint64 totalWallUs = 0;
+        qint64 maxWallUs = 0;
+        qint64 totalCpuUs = 0;
+        qint64 totalOutputBytes = 0;
+        int lastExitCode = 0;
+        quint64 histogram[HistogramBuckets] = {};
+    };
+
+    // Shared by everything that spawns processes, owned by the application
+    static CommandStats *instance();
+
+    // A short name grouping runs of the same command, e.g. "nmcli radio" or "sh apt"
+    static QString commandKey(const QString &program, const QStringList &arguments);
+
+    // Call once a command has been reaped. A negative exit code marks a failed run.
+    void record(const QString &command, qint64 wallUs, int exitCode, qint64 outputBytes);
+
+    // Detached commands are never reaped by us, only the spawn is counted
+    void recordDetached(const QString &command, bool started);
+
+    QHash<QString, Entry> snapshot() const;
+
+    // One line per command, slowest first, for the debug overlay
+    QStringList summaryLines() const;
+
+    // Write everything as JSON, the default path comes from HOMESCREEN_COMMAND_STATS
+    bool dump(const QString &path = QString()) const;
+    static QString defaultDumpPath();
+
+private:
+    explicit CommandStats(QObject *parent = nullptr);
+
+    // CPU time of children reaped since the previous call
+    qint64 takeChildCpuUs();
+
+    static int bucketFor(qint64 wallUs);
+    static qint64 percentileMs(const Entry &entry, double fraction);
+
+    mutable QMutex mutex;
+    QHash<QString, Entry> entries;
+    qint64 lastChildCpuUs;
+};
+
+#endif // COMMANDSTATS_H
@@ -0,0 +1,116 @@
+#include "ControlRegistry.h"
+#include "NetworkControls.h"
+#include "SecurityControls.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
+
+#include <QLayout>
+#include <QTimer>
+
+ControlRegistry::ControlRegistry(QWidget *panel, QObject *parent)
+    : QObject(parent),
+    panel(panel),
+    current(-1)
+{
+    for (int i = 0; i < ControlCount; ++i)
+    {
+        controls[i] = nullptr;
+    }
+}
+
+void ControlRegistry::prewarm()
+{
+    for (int i = 0; i < ControlCount; ++i)
+    {
+        if (!controls[i])
+        {
+            widget(Control(i));
+
+            // Leave the event loop a turn between constructors
+            QTimer::singleShot(0, this, &ControlRegistry::prewarm);
+            return;
+        }
+    }
+}
+
+QWidget *ControlRegistry::activate(Control control)
+{
+    StallWatchdog::Scope stallScope("ControlRegistry::activate");
+    TRACE_SCOPE("ControlRegistry::activate");
+
+    QWidget *shown = widget(control);
+    if (current != control)
+    {
+        if (current >= 0)
+        {
+            setActive(Control(current), false);
+            controls[current]->hide();
+        }
+        current = control;
+    }
+
+    shown->show();
+    setActive(control, true);
+    return shown;
+}
+
+void ControlRegistry::deactivate()
+{
+    if (current >= 0)
+    {
+        setActive(Control(current), false);
+    }
+}
+
+QWidget *ControlRegistry::widget(Control control)
+{
+    if (controls[control])
+    {
+        return controls[control];
+    }
+
+    StallWatchdog::Scope stallScope("ControlRegistry::widget");
+    TRACE_SCOPE("ControlRegistry::widget");
+
+    QWidget *created = nullptr;
+    switch (control)
+    {
+    case Network:
+        created = new NetworkControls(panel);
+        break;
+    case Security:
+        created = new SecurityControls(panel);
+        break;
+    case ControlCount:
+        return nullptr;
+    }
+
+    // Parked hidden in the panel, hidden widgets take no room in the layout
+    created->hide();
+    if (panel->layout())
+    {
+        panel->layout()->addWidget(created);
+    }
+    controls[control] = created;
+    return created;
+}
+
+bool ControlRegistry::isBuilt(Control control) const
+{
+    return controls[control] != nullptr;
+}
+
+void ControlRegistry::setActive(Control control, bool active)
+{
+    switch (control)
+    {
+    case Network:
+        static_cast<NetworkControls*>(controls[control])->setActive(active);
+        break;
+    case Security:
+        static_cast<SecurityControls*>(controls[control])->setActive(active);
+        break;
+    case ControlCount:
+        break;
+    }
+}
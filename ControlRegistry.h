@@ -0,0 +1,49 @@
+#ifndef CONTROLREGISTRY_H
+#define CONTROLREGISTRY_H
+
+#include <QObject>
+#include <QWidget>
+
+class NetworkControls;
+class SecurityControls;
+
+// Owns the one instance of every option panel control. Controls are built once,
+// ahead of time by prewarm() or on the first tap, live in the option panel's
+// layout and are only shown, hidden, activated and deactivated from then on.
+class ControlRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Control
+    {
+        Network,
+        Security,
+        ControlCount
+    };
+
+    // Controls are created as children of the panel and added to its layout
+    explicit ControlRegistry(QWidget *panel, QObject *parent = nullptr);
+
+    // Build the controls that do not exist yet, one per event loop pass
+    void prewarm();
+
+    // Show and activate a control, the previously active one is deactivated and hidden
+    QWidget *activate(Control control);
+
+    // Stop the active control's probes, it stays visible while the panel slides away
+    void deactivate();
+
+    // The control, built on the spot if prewarm has not reached it
+    QWidget *widget(Control control);
+    bool isBuilt(Control control) const;
+
+private:
+    void setActive(Control control, bool active);
+
+    QWidget *panel;
+    QWidget *controls[ControlCount];
+    int current; // -1 when nothing is active
+};
+
+#endif // CONTROLREGISTRY_H
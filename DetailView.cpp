@@ -0,0 +1,94 @@
+#include "DetailView.h"
+
+DetailView::DetailView(QWidget *parent)
+    : QWidget(parent),
+    layout(new QVBoxLayout(this)),
+    lineWidth(0)
+{
+    // Font for the detail lines
+    lineFont = font();
+    lineFont.setPointSize(16);
+    lineFont.setFamily("Arial");
+
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    setLayout(layout);
+}
+
+void DetailView::setLineWidth(int width)
+{
+    lineWidth = width;
+    if (lineWidth <= 0)
+    {
+        return;
+    }
+    for (QLabel *label : std::as_const(labels))
+    {
+        label->setWordWrap(true);
+        label->setFixedWidth(lineWidth);
+    }
+}
+
+void DetailView::setLines(const QStringList &lines)
+{
+    ++counters.updates;
+
+    // Nothing changed, leave the labels and the layout alone
+    if (lines == currentLines)
+    {
+        ++counters.unchangedUpdates;
+        counters.labelsReused += lines.size();
+        return;
+    }
+
+    // Every label that already exists saves an allocation compared to rebuilding
+    counters.labelsReused += qMin(labels.size(), lines.size());
+
+    // Only grow, labels beyond the current line count are hidden instead of deleted
+    while (labels.size() < lines.size())
+    {
+        labels.append(createLabel());
+    }
+
+    for (int i = 0; i < labels.size(); ++i)
+    {
+        QLabel *label = labels.at(i);
+        if (i < lines.size())
+        {
+            if (label->text() != lines.at(i))
+            {
+                label->setText(lines.at(i));
+                ++counters.textChanges;
+            }
+            if (label->isHidden())
+            {
+                label->show();
+            }
+        }
+        else if (!label->isHidden())
+        {
+            label->hide();
+        }
+    }
+
+    currentLines = lines;
+}
+
+const DetailView::Stats &DetailView::stats() const
+{
+    return counters;
+}
+
+QLabel *DetailView::createLabel()
+{
+    QLabel *label = new QLabel(this);
+    label->setFont(lineFont);
+    if (lineWidth > 0)
+    {
+        label->setWordWrap(true);
+        label->setFixedWidth(lineWidth);
+    }
+    layout->addWidget(label);
+    ++counters.labelsCreated;
+    return label;
+}
@@ -0,0 +1,47 @@
+#ifndef DETAILVIEW_H
+#define DETAILVIEW_H
+
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QList>
+#include <QStringList>
+
+// A column of text lines that keeps its labels between updates and only
+// touches the ones whose text actually changed.
+class DetailView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        quint64 updates = 0;           // setLines calls
+        quint64 unchangedUpdates = 0;  // calls that changed nothing at all
+        quint64 labelsCreated = 0;     // labels allocated over the view's lifetime
+        quint64 labelsReused = 0;      // labels that would have been recreated before
+        quint64 textChanges = 0;       // setText calls actually made
+    };
+
+    explicit DetailView(QWidget *parent = nullptr);
+
+    // Wrap lines at a fixed width, 0 lets labels size themselves
+    void setLineWidth(int width);
+
+    // Show the given lines, reusing the existing labels
+    void setLines(const QStringList &lines);
+
+    const Stats &stats() const;
+
+private:
+    QLabel *createLabel();
+
+    QVBoxLayout *layout;
+    QList<QLabel *> labels;
+    QStringList currentLines;
+    QFont lineFont;
+    int lineWidth;
+    Stats counters;
+};
+
+#endif // DETAILVIEW_H
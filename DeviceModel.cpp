@@ -0,0 +1,123 @@
+#include "DeviceModel.h"
+#include "DeviceRegistry.h"
+
+#include <QDateTime>
+#include <algorithm>
+
+// Constructor
+DeviceModel::DeviceModel(DeviceRegistry *registry, const QString &room, QObject *parent)
+    : QAbstractListModel(parent),
+    registry(registry),
+    roomFilter(room),
+    room(room.isEmpty() ? -1 : registry->findRoom(room))
+{
+    connect(registry, &DeviceRegistry::rowsAdded, this, &DeviceModel::registryRowsAdded);
+    connect(registry, &DeviceRegistry::rowsChanged, this, &DeviceModel::registryRowsChanged);
+
+    if (registry->count() > 0)
+    {
+        registryRowsAdded(0, registry->count() - 1);
+    }
+}
+
+int DeviceModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant DeviceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size())
+    {
+        return QVariant();
+    }
+
+    const int row = rows.at(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return registry->name(row);
+    case IdRole:
+        return registry->id(row);
+    case TypeRole:
+        return int(registry->type(row));
+    case RoomRole:
+        return registry->roomName(registry->room(row));
+    case StateRole:
+        return registry->state(row);
+    case StateTextRole:
+        return DeviceRegistry::stateText(registry->type(row), registry->state(row));
+    case UpdatedRole:
+        return QDateTime::fromMSecsSinceEpoch(registry->updatedAt(row));
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DeviceModel::roleNames() const
+{
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names.insert(IdRole, "deviceId");
+    names.insert(TypeRole, "type");
+    names.insert(RoomRole, "room");
+    names.insert(StateRole, "state");
+    names.insert(StateTextRole, "stateText");
+    names.insert(UpdatedRole, "updatedAt");
+    return names;
+}
+
+int DeviceModel::registryRow(int row) const
+{
+    return rows.value(row, -1);
+}
+
+void DeviceModel::registryRowsAdded(int first, int last)
+{
+    // The new rows may bring the first device of our room
+    if (room < 0 && !roomFilter.isEmpty())
+    {
+        room = registry->findRoom(roomFilter);
+        if (room < 0)
+        {
+            return;
+        }
+    }
+
+    // One pass over the room column only
+    QList<int> added;
+    for (int row = first; row <= last; ++row)
+    {
+        if (accepts(row))
+        {
+            added.append(row);
+        }
+    }
+    if (added.isEmpty())
+    {
+        return;
+    }
+
+    // Registry rows are only appended, so ours stay sorted
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + added.size() - 1);
+    rows.append(added);
+    endInsertRows();
+}
+
+void DeviceModel::registryRowsChanged(int first, int last)
+{
+    // Our rows between first and last are consecutive in the model
+    const auto begin = std::lower_bound(rows.cbegin(), rows.cend(), first);
+    const auto end = std::upper_bound(begin, rows.cend(), last);
+    if (begin == end)
+    {
+        return;
+    }
+
+    static const QList<int> roles = {StateRole, StateTextRole, UpdatedRole};
+    emit dataChanged(index(int(begin - rows.cbegin())), index(int(end - rows.cbegin()) - 1), roles);
+}
+
+bool DeviceModel::accepts(int registryRow) const
+{
+    return roomFilter.isEmpty() || registry->roomColumn().at(registryRow) == room;
+}
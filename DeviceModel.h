@@ -0,0 +1,52 @@
+#ifndef DEVICEMODEL_H
+#define DEVICEMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+
+class DeviceRegistry;
+
+// The devices of one room as a list model over the registry. The model keeps
+// only the registry rows it shows, in registry order, so a changed range of
+// the registry maps to a single range of model rows found by binary search
+// and is passed on as one dataChanged.
+class DeviceModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        IdRole = Qt::UserRole + 1,
+        TypeRole,
+        RoomRole,
+        StateRole,
+        StateTextRole,
+        UpdatedRole
+    };
+
+    // An empty room shows every device, a room the registry does not know yet
+    // shows none until its first device is added
+    DeviceModel(DeviceRegistry *registry, const QString &room, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // Registry row shown at a model row
+    int registryRow(int row) const;
+
+private slots:
+    void registryRowsAdded(int first, int last);
+    void registryRowsChanged(int first, int last);
+
+private:
+    bool accepts(int registryRow) const;
+
+    DeviceRegistry *registry;
+    QString roomFilter; // empty for every room
+    int room; // roomFilter's index in the registry, -1 while it has no such room
+    QList<int> rows;
+};
+
+#endif // DEVICEMODEL_H
@@ -0,0 +1,275 @@
+#include "DeviceRegistry.h"
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// About one frame, updates arriving within it are announced together
+const int FlushIntervalMs = 16;
+
+// Changed runs this close are announced as one range. Views repaint at most once
+// a frame anyway, the unchanged rows in between cost nothing extra.
+const int MergeGap = 32;
+
+} // namespace
+
+// Constructor
+DeviceRegistry::DeviceRegistry(QObject *parent)
+    : QObject(parent)
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FlushIntervalMs);
+    connect(&flushTimer, &QTimer::timeout, this, &DeviceRegistry::flush);
+}
+
+DeviceRegistry *DeviceRegistry::instance()
+{
+    static DeviceRegistry *registry = nullptr;
+    if (!registry)
+    {
+        registry = new DeviceRegistry(qApp);
+
+        QString path = qEnvironmentVariable("HOMESCREEN_DEVICES");
+        if (!path.isEmpty())
+        {
+            registry->load(path);
+        }
+    }
+    return registry;
+}
+
+bool DeviceRegistry::load(const QString &path)
+{
+    TRACE_SCOPE("DeviceRegistry::load");
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Device list not readable at" << path;
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (!document.isArray())
+    {
+        qDebug() << "Device list at" << path << "is not an array:" << error.errorString();
+        return false;
+    }
+
+    const QJsonArray devices = document.array();
+    const int first = count();
+    ids.reserve(first + devices.size());
+    types.reserve(first + devices.size());
+    rooms.reserve(first + devices.size());
+    states.reserve(first + devices.size());
+    updated.reserve(first + devices.size());
+    names.reserve(first + devices.size());
+
+    // Appended without a signal per device, one rowsAdded covers the file
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const QJsonValue &value : devices)
+    {
+        const QJsonObject device = value.toObject();
+        const quint32 deviceId = quint32(device.value("id").toInteger());
+        if (rowById.contains(deviceId))
+        {
+            continue;
+        }
+        rowById.insert(deviceId, ids.size());
+        ids.append(deviceId);
+        names.append(device.value("name").toString());
+        types.append(typeFromName(device.value("type").toString()));
+        rooms.append(internRoom(device.value("room").toString()));
+        states.append(device.value("state").toInt());
+        updated.append(now);
+    }
+    dirty.resize(count());
+
+    if (count() > first)
+    {
+        emit rowsAdded(first, count() - 1);
+    }
+    return true;
+}
+
+int DeviceRegistry::add(quint32 id, const QString &name, Type type, const QString &room, qint32 state)
+{
+    auto it = rowById.constFind(id);
+    if (it != rowById.constEnd())
+    {
+        setState(id, state);
+        return *it;
+    }
+
+    const int newRow = ids.size();
+    rowById.insert(id, newRow);
+    ids.append(id);
+    names.append(name);
+    types.append(type);
+    rooms.append(internRoom(room));
+    states.append(state);
+    updated.append(QDateTime::currentMSecsSinceEpoch());
+    dirty.resize(count());
+
+    emit rowsAdded(newRow, newRow);
+    return newRow;
+}
+
+int DeviceRegistry::count() const
+{
+    return ids.size();
+}
+
+int DeviceRegistry::row(quint32 id) const
+{
+    return rowById.value(id, -1);
+}
+
+quint16 DeviceRegistry::internRoom(const QString &room)
+{
+    int index = roomNames.indexOf(room);
+    if (index < 0)
+    {
+        index = roomNames.size();
+        roomNames.append(room);
+    }
+    return quint16(index);
+}
+
+int DeviceRegistry::findRoom(const QString &room) const
+{
+    return roomNames.indexOf(room);
+}
+
+QString DeviceRegistry::roomName(quint16 room) const
+{
+    return roomNames.value(room);
+}
+
+quint32 DeviceRegistry::id(int row) const
+{
+    return ids.at(row);
+}
+
+QString DeviceRegistry::name(int row) const
+{
+    return names.at(row);
+}
+
+DeviceRegistry::Type DeviceRegistry::type(int row) const
+{
+    return Type(types.at(row));
+}
+
+quint16 DeviceRegistry::room(int row) const
+{
+    return rooms.at(row);
+}
+
+qint32 DeviceRegistry::state(int row) const
+{
+    return states.at(row);
+}
+
+qint64 DeviceRegistry::updatedAt(int row) const
+{
+    return updated.at(row);
+}
+
+const QList<quint16> &DeviceRegistry::roomColumn() const
+{
+    return rooms;
+}
+
+void DeviceRegistry::setState(quint32 id, qint32 state)
+{
+    const int changed = row(id);
+    if (changed < 0)
+    {
+        return;
+    }
+
+    states[changed] = state;
+    updated[changed] = QDateTime::currentMSecsSinceEpoch();
+
+    if (!dirty.testBit(changed))
+    {
+        dirty.setBit(changed);
+        dirtyRows.append(changed);
+    }
+    if (!flushTimer.isActive())
+    {
+        flushTimer.start();
+    }
+}
+
+void DeviceRegistry::flush()
+{
+    TRACE_SCOPE("DeviceRegistry::flush");
+
+    flushTimer.stop();
+    if (dirtyRows.isEmpty())
+    {
+        return;
+    }
+
+    // Taken first, a receiver may queue new changes
+    QList<int> changed;
+    changed.swap(dirtyRows);
+    std::sort(changed.begin(), changed.end());
+    for (int changedRow : std::as_const(changed))
+    {
+        dirty.clearBit(changedRow);
+    }
+
+    int first = changed.first();
+    int last = first;
+    for (int i = 1; i < changed.size(); ++i)
+    {
+        const int next = changed.at(i);
+        if (next - last > MergeGap)
+        {
+            emit rowsChanged(first, last);
+            first = next;
+        }
+        last = next;
+    }
+    emit rowsChanged(first, last);
+}
+
+DeviceRegistry::Type DeviceRegistry::typeFromName(const QString &name)
+{
+    static const QHash<QString, Type> byName = {
+        {"light", Light},
+        {"switch", Switch},
+        {"plug", Plug},
+        {"thermostat", Thermostat},
+        {"sensor", Sensor}
+    };
+    return byName.value(name.toLower(), OtherType);
+}
+
+QString DeviceRegistry::stateText(Type type, qint32 state)
+{
+    switch (type)
+    {
+    case Light:
+    case Switch:
+    case Plug:
+        return state ? "On" : "Off";
+    case Thermostat:
+        // Tenths of a degree
+        return QString::number(state / 10.0, 'f', 1) + "°C";
+    default:
+        return QString::number(state);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef DEVICEREGISTRY_H
+#define DEVICEREGISTRY_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// Every device the panel knows about, one row each. The fields are kept as
+// parallel arrays (structure of arrays), so a pass over one field, like the
+// room filter of a model, walks a single dense array. Rows are only appended,
+// a device keeps its row for the lifetime of the registry.
+//
+// setState() writes the new value at once but only marks the row; changed rows
+// are announced about once a frame as a few merged ranges, so a burst of
+// updates costs a handful of signals instead of one per update.
+class DeviceRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Type : quint8
+    {
+        Light,
+        Switch,
+        Plug,
+        Thermostat,
+        Sensor,
+        OtherType
+    };
+
+    explicit DeviceRegistry(QObject *parent = nullptr);
+
+    // Shared by all pages, owned by the application and loaded from HOMESCREEN_DEVICES
+    static DeviceRegistry *instance();
+
+    // Read a JSON array of {"id", "name", "type", "room", "state"} objects, returns false if unreadable
+    bool load(const QString &path);
+
+    // Returns the row, a known id is updated in place
+    int add(quint32 id, const QString &name, Type type, const QString &room, qint32 state);
+
+    int count() const;
+    int row(quint32 id) const; // -1 when unknown
+
+    // Rooms are interned, a room index stays valid once handed out
+    quint16 internRoom(const QString &room);
+    int findRoom(const QString &room) const; // -1 when no device is in that room
+    QString roomName(quint16 room) const;
+
+    quint32 id(int row) const;
+    QString name(int row) const;
+    Type type(int row) const;
+    quint16 room(int row) const;
+    qint32 state(int row) const;
+    qint64 updatedAt(int row) const; // ms since the epoch
+
+    // Room column as a whole, for filtering
+    const QList<quint16> &roomColumn() const;
+
+    // Queue a state change, it is readable at once and announced with the others of the frame
+    void setState(quint32 id, qint32 state);
+
+    // Announce queued changes now
+    void flush();
+
+    static Type typeFromName(const QString &name);
+    static QString stateText(Type type, qint32 state);
+
+signals:
+    // Rows first to last were appended
+    void rowsAdded(int first, int last);
+
+    // One per merged run of changed rows, rows in the gaps may be unchanged
+    void rowsChanged(int first, int last);
+
+private:
+    QList<quint32> ids;
+    QList<quint8> types;
+    QList<quint16> rooms;
+    QList<qint32> states;
+    QList<qint64> updated;
+    QStringList names;
+
+    QHash<quint32, int> rowById;
+    QStringList roomNames;
+
+    // Rows changed since the last flush, the bits keep each row in the list once
+    QList<int> dirtyRows;
+    QBitArray dirty;
+    QTimer flushTimer;
+};
+
+#endif // DEVICEREGISTRY_H
@@ -0,0 +1,51 @@
+#include "DeviceTileDelegate.h"
+#include "DeviceModel.h"
+#include "DeviceRegistry.h"
+#include "Theme.h"
+
+#include <QPainter>
+
+namespace {
+
+const qreal CornerRadius = 5;
+
+} // namespace
+
+DeviceTileDelegate::DeviceTileDelegate(int tileSize, QObject *parent)
+    : QStyledItemDelegate(parent),
+    tileSize(tileSize)
+{
+}
+
+void DeviceTileDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const DeviceRegistry::Type type = DeviceRegistry::Type(index.data(DeviceModel::TypeRole).toInt());
+    const bool switchable = type == DeviceRegistry::Light || type == DeviceRegistry::Switch ||
+                            type == DeviceRegistry::Plug;
+    const bool on = switchable && index.data(DeviceModel::StateRole).toInt() != 0;
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(Theme::color(on ? Theme::Color::Selection : Theme::Color::Tile));
+    painter->drawRoundedRect(option.rect, CornerRadius, CornerRadius);
+
+    // Name in the upper half, state in the lower one
+    QRect upper = option.rect;
+    upper.setBottom(option.rect.center().y());
+    QRect lower = option.rect;
+    lower.setTop(option.rect.center().y());
+
+    painter->setPen(Theme::color(Theme::Color::Text));
+    painter->setFont(option.font);
+    painter->drawText(upper, Qt::AlignHCenter | Qt::AlignBottom | Qt::TextWordWrap,
+                      index.data(Qt::DisplayRole).toString());
+    painter->drawText(lower, Qt::AlignHCenter | Qt::AlignTop,
+                      index.data(DeviceModel::StateTextRole).toString());
+    painter->restore();
+}
+
+QSize DeviceTileDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const
+{
+    return QSize(tileSize, tileSize);
+}
@@ -0,0 +1,23 @@
+#ifndef DEVICETILEDELEGATE_H
+#define DEVICETILEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints a DeviceModel row as a tile like the TileGrid ones: the name over its
+// state, in the selection colour while the device is on. Every tile has the
+// same size so the view can lay out any number of them without measuring.
+class DeviceTileDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceTileDelegate(int tileSize, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    const int tileSize;
+};
+
+#endif // DEVICETILEDELEGATE_H
@@ -0,0 +1,56 @@
+#include "FirstFrameTimer.h"
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+#include <cstdio>
+
+void FirstFrameTimer::watchFromEnvironment(QWidget *window)
+{
+    if (qEnvironmentVariableIsEmpty("HOMESCREEN_EXIT_AFTER_FIRST_FRAME"))
+    {
+        return;
+    }
+    new FirstFrameTimer(window, qEnvironmentVariableIntValue("HOMESCREEN_FIRST_FRAME_BUDGET_MS"));
+}
+
+FirstFrameTimer::FirstFrameTimer(QWidget *window, int budgetMs)
+    : QObject(window),
+    window(window),
+    budgetMs(budgetMs),
+    painted(false)
+{
+    window->installEventFilter(this);
+}
+
+bool FirstFrameTimer::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!painted && watched == window && event->type() == QEvent::Paint)
+    {
+        // The backing store is flushed after the paint returns, the queued call runs after that
+        painted = true;
+        window->removeEventFilter(this);
+        QTimer::singleShot(0, this, &FirstFrameTimer::finish);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void FirstFrameTimer::finish()
+{
+    Trace::instant("first frame");
+    const double elapsedMs = Trace::elapsedNs() / 1e6;
+
+    // Plain stdout so scripts can read it without Qt's message formatting
+    std::printf("time to first frame: %.1f ms\n", elapsedMs);
+    std::fflush(stdout);
+
+    const bool overBudget = budgetMs > 0 && elapsedMs > budgetMs;
+    if (overBudget)
+    {
+        std::printf("over the %d ms budget\n", budgetMs);
+        std::fflush(stdout);
+    }
+    QCoreApplication::exit(overBudget ? 1 : 0);
+}
@@ -0,0 +1,35 @@
+#ifndef FIRSTFRAMETIMER_H
+#define FIRSTFRAMETIMER_H
+
+#include <QObject>
+
+class QWidget;
+
+// Startup benchmark mode. With HOMESCREEN_EXIT_AFTER_FIRST_FRAME set, the time
+// from process start to the first painted frame of the window is printed and
+// the app exits, writing the trace on the way out when tracing is on. The exit
+// code is 1 when the time is over HOMESCREEN_FIRST_FRAME_BUDGET_MS, so a script
+// can gate on it.
+class FirstFrameTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Does nothing unless the mode is enabled
+    static void watchFromEnvironment(QWidget *window);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    FirstFrameTimer(QWidget *window, int budgetMs);
+
+    // Runs once the first paint has been flushed
+    void finish();
+
+    QWidget *window;
+    int budgetMs; // 0 for no budget
+    bool painted;
+};
+
+#endif // FIRSTFRAMETIMER_H
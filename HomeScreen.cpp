@@ -1,7 +1,24 @@
 #include "HomeScreen.h"
-#include "NetworkControls.h"
-#include "SecurityControls.h"
+#include "ControlRegistry.h"
 #include "Weather.h"
+#include "ProbeScheduler.h"
+#include "CommandStats.h"
+#include "DetailView.h"
+#include "StallWatchdog.h"
+#include "IconCache.h"
+#include "Theme.h"
+#include "TileGrid.h"
+#include "PanelSnapshot.h"
+#include "SwipeGesture.h"
+#include "MinuteClock.h"
+#include "IdleMonitor.h"
+#include "DeviceModel.h"
+#include "DeviceRegistry.h"
+#include "DeviceTileDelegate.h"
+#include "StaticTextLabel.h"
+#include "Trace.h"
+#include <QApplication>
+#include <QListView>
 #include <QTime>
 #include <QDate>
 #include <QProcess>
@@ -11,31 +28,44 @@
 #include <QDebug>
 #include <QPixmap>
 #include <QPainter>
+#include <QShortcut>
+#include <QLocale>
+#include <QTimer>
 #include <cmath>
 
-NetworkControls *networkControls;
-SecurityControls *securityControls;
+// Area pages kept built, the least recently shown one is deleted beyond this
+static const int MaxAreaPages = 3;
+
+// While idle only the current area page is kept, and this much of the icon cache
+static const int IdleAreaPages = 1;
+static const qint64 IdleIconBudgetBytes = 128 * 1024;
+
+// Option panel swipes: the handle height, and the release speed in px/s that closes the
+// panel however short the swipe was
+static const int PanelHandleHeight = 80;
+static const qreal PanelFlingVelocity = 1000;
 
 // Constructor
 HomeScreen::HomeScreen(QWidget *parent)
     : QMainWindow(parent),
-    timer(new QTimer(this)),
-    weatherTimer(new QTimer(this)),
     weather(new Weather(this)),
+    clock(new MinuteClock(this)),
     currentAreaButton(nullptr),
-    currentItemButton(nullptr),
-    networkControls(new NetworkControls(this)),
-    securityControls(new SecurityControls(this)),
-    isDragging(false),
-    dragThreshold(500),
-    optionPanelAnimation(new QPropertyAnimation(this))
+    controls(nullptr),
+    optionPanelAnimation(new QPropertyAnimation(this)),
+    commandStatsOverlay(nullptr),
+    commandStatsProbe(0),
+    idleMonitor(nullptr),
+    idleOverlay(nullptr)
 {
+    TRACE_SCOPE("HomeScreen::HomeScreen");
+
     // Create the central widget
     centralWidget = new QWidget(this);
     setCentralWidget(centralWidget);
 
-    // Set the background color to a dark blue
-    centralWidget->setStyleSheet("background-color: rgba(23,27,46,255);");
+    // The dark blue background comes from the theme
+    centralWidget->setObjectName("background");
 
     // Add homescreen panels
     setUpTopPanel();
@@ -43,15 +73,14 @@ HomeScreen::HomeScreen(QWidget *parent)
     setUpItemPanel();
     setUpWeatherPanel();
     setUpOptionPanel();
+    setUpDebugOverlay();
 
-    // Connect the timer to update the time display
-    connect(timer, &QTimer::timeout, this, &HomeScreen::updateTime);
+    // The clock wakes once a minute and the date is only formatted again after midnight
+    connect(clock, &MinuteClock::minuteChanged, this, &HomeScreen::updateTime);
+    connect(clock, &MinuteClock::dateChanged, this, &HomeScreen::updateDate);
 
-    // Start the time to update every 1 second (1000ms)
-    timer->start(1000);
-
-    // Initial call to set the current time immediately
-    updateTime();
+    // Sets the current time and date immediately
+    clock->start();
 
     // Apply the layout geometry
     geometry();
@@ -59,50 +88,43 @@ HomeScreen::HomeScreen(QWidget *parent)
     // Install the event filter for the homescreen
     this->installEventFilter(this);
 
-    // Configure the option panel animation
-    optionPanelAnimation->setTargetObject(optionPanel);
-    optionPanelAnimation->setPropertyName("geometry");
+    // Configure the option panel animation, it moves the snapshot standing in for the panel
+    optionPanelAnimation->setTargetObject(optionPanelSnapshot);
+    optionPanelAnimation->setPropertyName("pos");
     optionPanelAnimation->setEasingCurve(QEasingCurve::OutCubic);
     optionPanelAnimation->setDuration(300);
+    connect(optionPanelAnimation, &QPropertyAnimation::finished, this, &HomeScreen::endPanelMotion);
 
-    connect(weather, &Weather::weatherDataUpdated, this, [this]() {
-        double tempVal = weather->getTemperature().toDouble();
-        double apparentVal = weather->getApparentTemperature().toDouble();
-        double precipVal = weather->getPrecipitation().toDouble();
-        double cloudVal = weather->getCloudCover().toDouble();
-        double windVal = weather->getWindSpeed().toDouble();
-        double windDir = weather->getWindDirection().toDouble();
-        double snowVal = weather->getSnowfall().toDouble();
-        bool day = (weather->getIsDay().toDouble() == 1.0);
-
-        QString tempStr = QString::number(tempVal, 'f', 1) + "°C";
-        QString apparentStr = "Feels Like: " + QString::number(apparentVal, 'f', 1) + "°C";
-
-        QString conditionKey;
-        if (snowVal >= 0.1) {
-            conditionKey = "Snow";
-        } else if (precipVal >= 0.1) {
-            conditionKey = "Rain";
-        } else if (precipVal < 0.1 && snowVal < 0.1 && windVal >= 8.0 && cloudVal < 20.0) {
-            conditionKey = day ? "Windy-Day" : "Windy-Night";
-        } else if (precipVal < 0.1 && snowVal < 0.1 && cloudVal >= 80.0) {
-            conditionKey = "Overcast";
-        } else if (precipVal < 0.1 && snowVal < 0.1 && cloudVal < 20.0) {
-            conditionKey = day ? "Clear-Day" : "Clear-Night";
-        } else {
-            conditionKey = day ? "Few-Clouds-Day" : "Few-Clouds-Night";
-        }
+    // Paint the cached weather in the first frame, fresh data replaces it when it arrives
+    connect(weather, &Weather::weatherDataUpdated, this, &HomeScreen::showWeather);
+    connect(weather, &Weather::fetchFailed, this, &HomeScreen::showWeather);
+    if (weather->hasData()) {
+        showWeather();
+    }
 
-        updateWeatherPanel(conditionKey, tempStr, apparentStr, windVal, windDir);
+    // Update weather info every ten minutes, a minute late does not matter. Hourly while idle.
+    ProbeScheduler::Probe weatherProbe;
+    weatherProbe.name = "weather";
+    weatherProbe.periodMs = 600000;
+    weatherProbe.toleranceMs = 60000;
+    weatherProbe.idlePeriodMs = 3600000;
+    weatherProbe.priority = ProbeScheduler::Low;
+    weatherProbe.context = weather;
+    weatherProbe.deliver = [this](const QVariant &) {
+        weather->updateWeatherData();
+    };
+    int weatherProbeId = ProbeScheduler::instance()->add(weatherProbe);
+
+    // Revalidate once the event loop runs instead of from the constructor
+    QTimer::singleShot(0, weather, [weatherProbeId]() {
+        ProbeScheduler::instance()->trigger(weatherProbeId);
     });
-    weather->updateWeatherData();
-
-    // Update weather info every minute
-    connect(weatherTimer, &QTimer::timeout, weather, &Weather::updateWeatherData);
-    weatherTimer->start(600000);
 
     // Display the homescreen
     this->show();
+
+    // Idle input is watched on the window, which only exists once shown
+    setUpIdleMode();
 }
 
 // Destructor
@@ -111,17 +133,20 @@ HomeScreen::~HomeScreen()
     // Cleanup
 }
 
-void HomeScreen::updateTime()
+void HomeScreen::updateTime(const QTime &time)
+{
+    StallWatchdog::Scope stallScope("HomeScreen::updateTime");
+    TRACE_SCOPE("HomeScreen::updateTime");
+
+    // Only the digits that changed are repainted
+    timeLabel->setText(time.toString("hh:mm"));
+}
+
+void HomeScreen::updateDate(const QDate &date)
 {
-    // Get and format the current time
-    QTime currentTime = QTime::currentTime();
-    QString timeString = currentTime.toString("hh:mm");
-    timeLabel->setText(timeString);
+    TRACE_SCOPE("HomeScreen::updateDate");
 
-    // Get and format the current date
-    QDate currentDate = QDate::currentDate();
-    QString dateString = currentDate.toString("ddd, MMM dd");
-    dateLabel->setText(dateString);
+    dateLabel->setText(date.toString("ddd, MMM dd"));
 }
 
 void HomeScreen::resizeEvent(QResizeEvent *event)
@@ -154,20 +179,20 @@ void HomeScreen::geometry()
                            timeLabel->width(),
                            timeLabel->height());
 
-    // Position the date label to the right of the time label
+    // Position the date label to the right of the time label, it grows to fit longer dates itself
     dateLabel->setGeometry(200,
                            (topPanel->height() - dateLabel->height()) / 2,
-                           dateLabel->width() + 20, // Sometimes date is too long for label? Gets cut off. Don't know why.
+                           dateLabel->width(),
                            dateLabel->height());
 
     // Area panel (under the top panel)
     areaPanel->setGeometry(0, topPanel->height(), windowWidth, windowHeight*0.08);
     areaPanel->setFixedHeight(100);
 
-    // Item panel (centered-ish)
+    // Item panel (centered-ish), device pages wrap at the window edge
     itemPanel->setGeometry(windowWidth / 2.5,
                              areaPanel->height() + topPanel->height(),
-                             windowWidth,
+                             windowWidth - windowWidth / 2.5,
                              windowHeight - areaPanel->height() - topPanel->height() - 50);
 
     // Weather panel (left of item panel)
@@ -181,17 +206,29 @@ void HomeScreen::geometry()
                              topPanel->height() + areaPanel->height() + 50,
                              windowWidth,
                              windowHeight - areaPanel->height() - topPanel->height() - 50);
+
+    // Keep the swipe handle on the panel
+    if (optionPanelHandle->isVisible())
+    {
+        placePanelHandle(optionPanel->pos());
+    }
+
+    // Keep the whole window covered while idle
+    if (idleOverlay && idleOverlay->isVisible())
+    {
+        idleOverlay->setGeometry(centralWidget->rect());
+    }
 }
 
 void HomeScreen::setUpTopPanel()
 {
+    TRACE_SCOPE("HomeScreen::setUpTopPanel");
+
     // Create the top panel widget
     topPanel = new QWidget(centralWidget);
-    topPanel->setStyleSheet("background-color: transparent;");
 
     // Create the title label
     titleLabel = new QLabel("Control Panel", topPanel); // Change title
-    titleLabel->setStyleSheet("background-color: transparent; color: white;");
     titleLabel->setAlignment(Qt::AlignCenter);
 
     // Font for the title
@@ -203,10 +240,7 @@ void HomeScreen::setUpTopPanel()
     titleLabel->adjustSize();
 
     // Create the time label
-    timeLabel = new QLabel("00:00", topPanel);
-    timeLabel->setStyleSheet("background-color: transparent; color: white;");
-    timeLabel->setAlignment(Qt::AlignCenter);
-    timeLabel->adjustSize();
+    timeLabel = new StaticTextLabel("00:00", topPanel);
 
     // Font for the time
     QFont timeFont = timeLabel->font();
@@ -217,25 +251,22 @@ void HomeScreen::setUpTopPanel()
     timeLabel->adjustSize();
 
     // Create the date label
-    dateLabel = new QLabel("Sun, Jan 01", topPanel);
-    dateLabel->setStyleSheet("background-color: transparent; color: white;");
-    dateLabel->setAlignment(Qt::AlignCenter);
-    dateLabel->adjustSize();
+    dateLabel = new StaticTextLabel("Sun, Jan 01", topPanel);
 
     // Font for the date
     QFont dateFont = dateLabel->font();
     dateFont.setPointSize(20);
     dateFont.setFamily("Arial");
     dateLabel->setFont(dateFont);
-    dateLabel->setAlignment(Qt::AlignLeft);
     dateLabel->adjustSize();
 }
 
 void HomeScreen::setUpAreaPanel()
 {
+    TRACE_SCOPE("HomeScreen::setUpAreaPanel");
+
     // Create the area panel widget
     areaPanel = new QWidget(centralWidget);
-    areaPanel->setStyleSheet("background-color: transparent;");
 
     // Create a horizontal layout
     areaPanelLayout = new QHBoxLayout(areaPanel);
@@ -252,16 +283,6 @@ void HomeScreen::setUpAreaPanel()
     areaButtonFont.setFamily("Arial");
     areaButtonFont.setBold(true);
 
-    // Default style for area buttons
-    QString areaButtonStyle = QString("background-color: transparent;"
-                                  "color: white;"
-                                  "border-radius: 30px;");
-
-    // Style for selected button (adds a blue background)
-    QString selectedAreaButtonStyle = QString("background-color: rgba(58,94,171,255);"
-                                          "color: white;"
-                                          "border-radius: 30px;");
-
     // Minimum size for the buttons
     QSize minimumButtonSize(160, 60);
     allDevicesButton->setMinimumSize(minimumButtonSize);
@@ -269,14 +290,14 @@ void HomeScreen::setUpAreaPanel()
     bedroomButton->setMinimumSize(minimumButtonSize);
     homeButton->setMinimumSize(minimumButtonSize);
 
-    // Apply all styles and fonts to the buttons
-    allDevicesButton->setStyleSheet(selectedAreaButtonStyle);
+    // Apply the theme role and fonts to the buttons
+    Theme::setRole(allDevicesButton, "area");
     allDevicesButton->setFont(areaButtonFont);
-    pcButton->setStyleSheet(areaButtonStyle);
+    Theme::setRole(pcButton, "area");
     pcButton->setFont(areaButtonFont);
-    bedroomButton->setStyleSheet(areaButtonStyle);
+    Theme::setRole(bedroomButton, "area");
     bedroomButton->setFont(areaButtonFont);
-    homeButton->setStyleSheet(areaButtonStyle);
+    Theme::setRole(homeButton, "area");
     homeButton->setFont(areaButtonFont);
 
     // Connect the buttons to the click handler
@@ -303,72 +324,134 @@ void HomeScreen::setUpAreaPanel()
     areaPanelLayout->setAlignment(Qt::AlignLeft);
 
     // Set the all devices button to be selected initially
+    Theme::setSelected(allDevicesButton, true);
     currentAreaButton = allDevicesButton;
 }
 
 void HomeScreen::areaButtonClicked()
 {
+    StallWatchdog::Scope stallScope("HomeScreen::areaButtonClicked");
+    TRACE_SCOPE("HomeScreen::areaButtonClicked");
+
     // Get the button that was clicked
     QPushButton *clickedAreaButton = qobject_cast<QPushButton*>(sender());
 
-    // Reset the style of the previously selected button
-    if (currentAreaButton)
-    {
-        currentAreaButton->setStyleSheet("background-color: transparent;"
-                                         "color: white;"
-                                         "border-radius: 30px;");
-    }
-
-    // Set the stle of the clicked button to indicate its selection
-    clickedAreaButton->setStyleSheet("background-color: rgba(58,94,171,255);"
-                                     "color: white;"
-                                     "border-radius: 30px;");
+    // Move the selection, each button is only re-polished against the application theme
+    Theme::setSelected(currentAreaButton, false);
+    Theme::setSelected(clickedAreaButton, true);
 
     // Update the current button
     currentAreaButton = clickedAreaButton;
 
-    // Clear the current option panel layout before showing the new one
-    QLayoutItem *child;
-    while ((child = itemPanelLayout->takeAt(0)) != 0)
+    // Pages are kept between visits, switching is a visibility flip once they exist
+    itemPanel->setCurrentWidget(areaPage(clickedAreaButton));
+}
+
+QWidget *HomeScreen::areaPage(QPushButton *areaButton)
+{
+    TRACE_SCOPE("HomeScreen::areaPage");
+
+    areaPageOrder.removeOne(areaButton);
+    areaPageOrder.append(areaButton);
+
+    QWidget *page = areaPages.value(areaButton);
+    if (page)
     {
-        delete child->widget();
-        delete child;
+        return page;
     }
 
-    // Reset the current item button when changing options (prevents crash)
-    currentItemButton = nullptr;
-
-    // Update the item panel based on the selected area button
-    if (clickedAreaButton == allDevicesButton)
+    if (areaButton == bedroomButton || areaButton == homeButton)
     {
-        allDevicesButtons();
+        // Rooms list their devices from the registry, however many there are.
+        // Home is the whole house, not a room of that name.
+        page = devicePage(areaButton == bedroomButton ? QString("Bedroom") : QString());
     }
-    else if (clickedAreaButton == pcButton)
+    else
     {
-        pcButtons();
+        // One widget paints every tile, small tiles take one 170px cell and large ones 2x2
+        TileGrid *grid = new TileGrid(itemPanel);
+        grid->setCellSize(170, 10);
+        connect(grid, &TileGrid::tileClicked, this, &HomeScreen::tileClicked);
+
+        if (areaButton == allDevicesButton)
+        {
+            allDevicesTiles(grid);
+        }
+        else if (areaButton == pcButton)
+        {
+            pcTiles(grid);
+        }
+        page = grid;
     }
+
+    itemPanel->addWidget(page);
+    areaPages.insert(areaButton, page);
+    trimAreaPages(MaxAreaPages);
+
+    return page;
 }
 
-static QPixmap recolorIcon(const QPixmap &original)
+void HomeScreen::trimAreaPages(int keep)
 {
-    QImage img = original.toImage().convertToFormat(QImage::Format_ARGB32);
-    QPixmap colored(img.size());
-    colored.fill(Qt::transparent);
+    // Drop the least recently shown pages, they are rebuilt if their area is visited again
+    while (areaPageOrder.size() > keep)
+    {
+        QPushButton *oldest = areaPageOrder.takeFirst();
+        QWidget *evicted = areaPages.take(oldest);
+        itemPanel->removeWidget(evicted);
+        evicted->deleteLater();
+    }
+}
 
-    QPainter p(&colored);
-    p.drawImage(0, 0, img);
-    p.setCompositionMode(QPainter::CompositionMode_SourceIn);
-    p.fillRect(img.rect(), Qt::white);
-    p.end();
+TileGrid *HomeScreen::currentPage() const
+{
+    return qobject_cast<TileGrid*>(itemPanel->currentWidget());
+}
 
-    return colored;
+QWidget *HomeScreen::devicePage(const QString &room)
+{
+    TRACE_SCOPE("HomeScreen::devicePage");
+
+    // Only the visible tiles are painted, and equal sizes keep the layout cheap for any count
+    QListView *page = new QListView(itemPanel);
+    page->setObjectName("devicePage");
+    page->setViewMode(QListView::IconMode);
+    page->setMovement(QListView::Static);
+    page->setResizeMode(QListView::Adjust);
+    page->setUniformItemSizes(true);
+    page->setSpacing(5);
+    page->setSelectionMode(QAbstractItemView::NoSelection);
+    page->setFocusPolicy(Qt::NoFocus);
+
+    // Same tiles as the TileGrid pages
+    QFont tileFont;
+    tileFont.setPointSize(16);
+    tileFont.setFamily("Arial");
+    tileFont.setBold(true);
+    page->setFont(tileFont);
+
+    page->setItemDelegate(new DeviceTileDelegate(170, page));
+    page->setModel(new DeviceModel(DeviceRegistry::instance(), room, page));
+    return page;
+}
+
+// Weather icons are drawn white at 100x100
+static IconCache::Key weatherIconKey(WeatherCondition condition, qreal devicePixelRatio)
+{
+    IconCache::Key key;
+    key.source = WeatherSnapshot::iconFile(condition);
+    key.size = QSize(100, 100);
+    key.tint = qRgb(255, 255, 255);
+    key.devicePixelRatio = devicePixelRatio;
+    return key;
 }
 
 void HomeScreen::setUpWeatherPanel()
 {
+    TRACE_SCOPE("HomeScreen::setUpWeatherPanel");
+
     weatherPanel = new QWidget(centralWidget);
-    weatherPanel->setStyleSheet("background-color: rgba(27,33,52,200);"
-                                "border-radius: 100;");
+    weatherPanel->setObjectName("weatherPanel");
 
     QFont weatherTemperatureFont;
     weatherTemperatureFont.setPointSize(60);
@@ -387,23 +470,24 @@ void HomeScreen::setUpWeatherPanel()
 
     weatherIconLabel = new QLabel(weatherPanel);
     weatherIconLabel->setAlignment(Qt::AlignCenter);
-    weatherIconLabel->setStyleSheet("background: transparent;");
-    QPixmap defaultIcon("");
-    weatherIconLabel->setPixmap(recolorIcon(defaultIcon).scaled(100,100, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+
+    // Render every condition icon in the background so weather updates only swap pixmaps
+    QList<IconCache::Key> icons;
+    for (int i = 0; i < int(WeatherCondition::Count); ++i) {
+        icons.append(weatherIconKey(WeatherCondition(i), devicePixelRatioF()));
+    }
+    IconCache::instance()->prewarm(icons);
 
     weatherTemperatureLabel = new QLabel("N/A", weatherPanel);
     weatherTemperatureLabel->setFont(weatherTemperatureFont);
-    weatherTemperatureLabel->setStyleSheet("background: transparent; color: white;");
     weatherTemperatureLabel->setAlignment(Qt::AlignCenter);
 
     weatherApparentTemperatureLabel = new QLabel("N/A", weatherPanel);
     weatherApparentTemperatureLabel->setFont(weatherApparentTemperatureFont);
-    weatherApparentTemperatureLabel->setStyleSheet("background: transparent; color: white;");
     weatherApparentTemperatureLabel->setAlignment(Qt::AlignCenter);
 
     weatherWindLabel = new QLabel("N/A", weatherPanel);
     weatherWindLabel->setFont(weatherWindFont);
-    weatherWindLabel->setStyleSheet("background: transparent; color: white;");
     weatherWindLabel->setAlignment(Qt::AlignCenter);
 
     weatherPanelLayout->addWidget(weatherIconLabel);
@@ -418,39 +502,68 @@ void HomeScreen::setUpWeatherPanel()
     weatherPanelLayout->setAlignment(Qt::AlignCenter);
 }
 
-void HomeScreen::updateWeatherPanel(const QString &condition, const QString &temperature, const QString &apparentTemperature, double windSpeedVal, double windDirVal)
+void HomeScreen::showWeather()
 {
-    weatherTemperatureLabel->setText(temperature);
-    weatherApparentTemperatureLabel->setText(apparentTemperature);
+    StallWatchdog::Scope stallScope("HomeScreen::showWeather");
+    TRACE_SCOPE("HomeScreen::showWeather");
+
+    if (!weather->hasData()) {
+        return;
+    }
+    const WeatherSnapshot &snapshot = weather->snapshot();
+
+    QString tempStr = QString::number(snapshot.temperature, 'f', 1) + "°C";
+    QString apparentStr = "Feels Like: " + QString::number(snapshot.apparentTemperature, 'f', 1) + "°C";
+
+    // Old values stay on screen but say how old they are
+    if (weather->isStale()) {
+        apparentStr += "\nas of " + QLocale().toString(weather->lastUpdated(), "ddd hh:mm");
+    }
+
+    updateWeatherPanel(snapshot.condition(), tempStr, apparentStr, snapshot.windSpeed, snapshot.windDirection);
+}
 
-    QString iconPath = "";
-
-    if (condition == "Clear-Day") {
-        iconPath += "weather-clear-symbolic.symbolic.png";
-    } else if (condition == "Clear-Night") {
-        iconPath += "weather-clear-night-symbolic.symbolic.png";
-    } else if (condition == "Overcast") {
-        iconPath += "weather-overcast-symbolic.symbolic.png";
-    } else if (condition == "Rain") {
-        iconPath += "weather-showers-symbolic.symbolic.png";
-    } else if (condition == "Few-Clouds-Day") {
-        iconPath += "weather-few-clouds-symbolic.symbolic.png";
-    } else if (condition == "Few-Clouds-Night") {
-        iconPath += "weather-few-clouds-night-symbolic.symbolic.png";
-    } else if (condition == "Snow") {
-        iconPath += "weather-snow-symbolic.symbolic.png";
-    } else if (condition == "Windy-Day" || condition == "Windy-Night") {
-        iconPath += "weather-windy-symbolic.symbolic.png";
-    } else {
-        iconPath += "weather-severe-alert-symbolic.symbolic.png";
+void HomeScreen::idleChanged(bool idle)
+{
+    StallWatchdog::Scope stallScope("HomeScreen::idleChanged");
+    TRACE_SCOPE("HomeScreen::idleChanged");
+
+    if (idle)
+    {
+        // Finish a slide in progress so its snapshot is released
+        if (optionPanelAnimation->state() == QAbstractAnimation::Running)
+        {
+            optionPanelAnimation->setCurrentTime(optionPanelAnimation->duration());
+        }
+
+        clock->stop();
+        ProbeScheduler::instance()->setIdle(true);
+
+        // Everything dropped here is rebuilt on demand
+        trimAreaPages(IdleAreaPages);
+        IconCache::instance()->trim(IdleIconBudgetBytes);
+
+        idleOverlay->setGeometry(centralWidget->rect());
+        idleOverlay->raise();
+        idleOverlay->show();
+    }
+    else
+    {
+        // Only what the next frame needs, probes that fell due catch up after it
+        idleOverlay->hide();
+        clock->start();
+        ProbeScheduler::instance()->setIdle(false);
     }
+}
+
+void HomeScreen::updateWeatherPanel(WeatherCondition condition, const QString &temperature, const QString &apparentTemperature, double windSpeedVal, double windDirVal)
+{
+    weatherTemperatureLabel->setText(temperature);
+    weatherApparentTemperatureLabel->setText(apparentTemperature);
 
-    QPixmap icon(iconPath);
-    if (!icon.isNull()) {
-        QPixmap whiteIcon = recolorIcon(icon).scaled(100,100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        weatherIconLabel->setPixmap(whiteIcon);
-    } else {
-        qDebug() << "Icon not found at:" << iconPath;
+    QPixmap icon = IconCache::instance()->pixmap(weatherIconKey(condition, devicePixelRatioF()));
+    if (!icon.isNull() && icon.cacheKey() != weatherIconLabel->pixmap().cacheKey()) {
+        weatherIconLabel->setPixmap(icon);
     }
 
     double dir = fmod((windDirVal + 22.5), 360);
@@ -464,281 +577,261 @@ void HomeScreen::updateWeatherPanel(const QString &condition, const QString &tem
 
 void HomeScreen::setUpOptionPanel()
 {
+    TRACE_SCOPE("HomeScreen::setUpOptionPanel");
+
     // Create the option panel widget
     optionPanel = new QWidget(centralWidget);
-    optionPanel->setStyleSheet("background-color: rgba(5,10,30,255);"
-                               "border-top-left-radius: 60px;"
-                               "border-top-right-radius: 60px;");
+    optionPanel->setObjectName("optionPanel");
 
     // Create a vertical layout
     optionPanelLayout = new QVBoxLayout(optionPanel);
     optionPanel->setLayout(optionPanelLayout);
 
-    // Install an event filter
-    qApp->installEventFilter(this);
+    // Picture of the panel that is moved while it slides
+    optionPanelSnapshot = new PanelSnapshot(centralWidget);
+
+    // One instance of each control, built once the first frame is out
+    controls = new ControlRegistry(optionPanel, this);
+    QTimer::singleShot(0, controls, &ControlRegistry::prewarm);
+
+    // Swipes are only recognised on the handle, nothing else sees the filter
+    optionPanelHandle = new QWidget(centralWidget);
+    optionPanelHandle->hide();
+    optionPanelSwipe = new SwipeGesture(optionPanelHandle);
+    connect(optionPanelSwipe, &SwipeGesture::started, this, &HomeScreen::panelSwipeStarted);
+    connect(optionPanelSwipe, &SwipeGesture::moved, this, &HomeScreen::panelSwipeMoved);
+    connect(optionPanelSwipe, &SwipeGesture::finished, this, &HomeScreen::panelSwipeFinished);
 
     // Hide the option panel until needed
     optionPanel->hide();
 }
 
-void HomeScreen::clearOptionPanelLayout()
+void HomeScreen::setUpDebugOverlay()
 {
-    // Loop through all items in the option panel layout
-    QLayoutItem *child;
-    while ((child = optionPanelLayout->takeAt(0)) != nullptr)
-    {
-        // Remove widget from its parent and schedule for deletion
-        if (child->widget())
-        {
-            child->widget()->setParent(nullptr);
-            child->widget()->deleteLater();
+    TRACE_SCOPE("HomeScreen::setUpDebugOverlay");
+
+    CommandStats *stats = CommandStats::instance();
+
+    // Hidden overlay listing what every external command costs, toggled with Ctrl+Shift+D
+    commandStatsOverlay = new DetailView(centralWidget);
+    commandStatsOverlay->setObjectName("debugOverlay");
+    commandStatsOverlay->setAttribute(Qt::WA_StyledBackground);
+    commandStatsOverlay->move(20, 20);
+    commandStatsOverlay->hide();
+
+    ProbeScheduler::Probe refresh;
+    refresh.name = "command-stats";
+    refresh.periodMs = 1000;
+    refresh.toleranceMs = 500;
+    refresh.priority = ProbeScheduler::Low;
+    refresh.context = commandStatsOverlay;
+    refresh.onlyWhileVisible = true;
+    refresh.deliver = [this, stats](const QVariant &) {
+        QStringList lines = stats->summaryLines();
+        if (StallWatchdog *watchdog = StallWatchdog::instance()) {
+            lines.append(watchdog->summaryLines());
         }
-        // Delete the layout item itself
-        delete child;
-    }
-}
-
-void HomeScreen::setUpItemPanel()
-{
-    // Create the item panel widget
-    itemPanel = new QWidget(centralWidget);
-    itemPanel->setStyleSheet("background-color: transparent;");
-
-    // Create a grid layout
-    itemPanelLayout = new QGridLayout(itemPanel);
-    itemPanelLayout->setSpacing(10);
-
-    // Set up the "all devices" buttons
-    allDevicesButtons();
+        lines.append(clock->summaryLines());
+        if (idleMonitor) {
+            lines.append(idleMonitor->summaryLines());
+        }
+        commandStatsOverlay->setLines(lines);
+        commandStatsOverlay->adjustSize();
+    };
+    commandStatsProbe = ProbeScheduler::instance()->add(refresh, false);
+
+    QShortcut *toggleOverlay = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(toggleOverlay, &QShortcut::activated, this, [this]() {
+        bool show = !commandStatsOverlay->isVisible();
+        commandStatsOverlay->setVisible(show);
+        ProbeScheduler::instance()->setEnabled(commandStatsProbe, show);
+        if (show) {
+            commandStatsOverlay->raise();
+            ProbeScheduler::instance()->trigger(commandStatsProbe);
+        }
+    });
 
-    // Set the grid layout for the item panel
-    itemPanel->setLayout(itemPanelLayout);
-    itemPanelLayout->setAlignment(Qt::AlignLeft | Qt::AlignCenter);
+    // Keep a recent copy on disk between releases, even if the panel never exits cleanly
+    ProbeScheduler::Probe dump;
+    dump.name = "command-stats-dump";
+    dump.periodMs = 300000;
+    dump.toleranceMs = 60000;
+    dump.priority = ProbeScheduler::Low;
+    dump.context = stats;
+    dump.work = [stats]() {
+        return QVariant(stats->dump());
+    };
+    ProbeScheduler::instance()->add(dump);
 }
 
-QPushButton* HomeScreen::setUpItemButton(const QString &text, const QSize &size, const QString &style, int row, int col, QGridLayout *layout)
+void HomeScreen::setUpIdleMode()
 {
-    // Create a new button with the given text
-    QPushButton *itemButton = new QPushButton(text);
-    itemButton->setFixedSize(size);
-    itemButton->setStyleSheet(style);
+    TRACE_SCOPE("HomeScreen::setUpIdleMode");
 
-    // Font for item buttons
-    QFont itemButtonFont;
-    itemButtonFont.setPointSize(16);
-    itemButtonFont.setFamily("Arial");
-    itemButtonFont.setBold(true);
-    itemButton->setFont(itemButtonFont);
+    // Black over the whole window while idle. It is opaque, so nothing underneath is painted.
+    idleOverlay = new QWidget(centralWidget);
+    idleOverlay->setObjectName("idleOverlay");
+    idleOverlay->setAttribute(Qt::WA_StyledBackground);
+    idleOverlay->setAttribute(Qt::WA_OpaquePaintEvent);
+    idleOverlay->hide();
 
-    // Add the button to the given layout at the given position
-    layout->addWidget(itemButton, row, col);
-    return itemButton;
+    idleMonitor = new IdleMonitor(windowHandle(), IdleMonitor::idleAfterFromEnvironment(), this);
+    connect(idleMonitor, &IdleMonitor::idleChanged, this, &HomeScreen::idleChanged);
 }
 
-void HomeScreen::allDevicesButtons()
+void HomeScreen::setUpItemPanel()
 {
-    // Create a widget to hold the secondary grid layout for the small buttons
-    QWidget *smallItemButtonsWidget = new QWidget;
+    TRACE_SCOPE("HomeScreen::setUpItemPanel");
 
-    // Define buttons sizes
-    QSize smallItemButtonSize(170, 170);
-    QSize largeItemButtonSize(350, 350);
+    // One page per area, only the current one is shown
+    itemPanel = new QStackedWidget(centralWidget);
 
-    // Default style for item buttons
-    QString itemButtonStyle = QString("background-color: rgba(27,33,52,200);"
-                                  "color: white;"
-                                  "border-radius: 5px;");
+    // Set up the "all devices" tiles
+    itemPanel->setCurrentWidget(areaPage(allDevicesButton));
 
-    // Style for selected button (adds a blue background)
-    QString selectedItemButtonStyle = QString("background-color: rgba(58,94,171,255);"
-                                          "color: white;"
-                                          "border-radius: 5px;");
-
-    // Create a secondary grid layout for the small buttons
-    QGridLayout *smallItemButtonLayout = new QGridLayout;
-
-    // Create the small buttons
-    getUpButton = setUpItemButton("Get Up", smallItemButtonSize, itemButtonStyle, 0, 0, smallItemButtonLayout);
-    leaveButton = setUpItemButton("Leave", smallItemButtonSize, itemButtonStyle, 0, 1, smallItemButtonLayout);
-    atHomeButton = setUpItemButton("Home", smallItemButtonSize, selectedItemButtonStyle, 1, 0, smallItemButtonLayout);
-    toSleepButton = setUpItemButton("Sleep", smallItemButtonSize, itemButtonStyle, 1, 1, smallItemButtonLayout);
-
-    // Create the large buttons
-    networkButton = setUpItemButton("Network", largeItemButtonSize, itemButtonStyle, 0, 1, itemPanelLayout);
-    lightsButton = setUpItemButton("Lights", largeItemButtonSize, itemButtonStyle, 1, 0, itemPanelLayout);
-    thermostatButton = setUpItemButton("Thermostat", largeItemButtonSize, itemButtonStyle, 1, 1, itemPanelLayout);
-
-    // Connect the small buttons to their click handler
-    connect(getUpButton, &QPushButton::clicked, this, &HomeScreen::statusButtonClicked);
-    connect(leaveButton, &QPushButton::clicked, this, &HomeScreen::statusButtonClicked);
-    connect(atHomeButton, &QPushButton::clicked, this, &HomeScreen::statusButtonClicked);
-    connect(toSleepButton, &QPushButton::clicked, this, &HomeScreen::statusButtonClicked);
-
-    // Connect the large buttons to their click handler
-    connect(networkButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(lightsButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(thermostatButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-
-    // Set up the for the small buttons
-    smallItemButtonLayout->setSpacing(10);
-    smallItemButtonLayout->setContentsMargins(0, 0, 0, 0);
-    smallItemButtonsWidget->setLayout(smallItemButtonLayout);
-
-    // Add the small buttons widget to the main item panel layout
-    itemPanelLayout->addWidget(smallItemButtonsWidget, 0, 0);
-
-    // Set the initial status button as "At Home"
-    currentStatusButton = atHomeButton;
+    // Build the PC page once the first frame is out so the first switch to it is instant
+    QTimer::singleShot(0, this, [this]() {
+        if (!areaPages.contains(pcButton))
+        {
+            areaPage(pcButton);
+            areaPageOrder.removeOne(pcButton);
+            areaPageOrder.prepend(pcButton);
+        }
+    });
 }
 
-void HomeScreen::pcButtons()
+void HomeScreen::allDevicesTiles(TileGrid *page)
 {
-    // Create a widget to hold the secondary grid layout for the small buttons
-    QWidget *smallItemButtonsWidget = new QWidget;
-
-    // Define buttons sizes
-    QSize smallItemButtonSize(170, 170);
-    QSize largeItemButtonSize(350, 350);
-
-    // Default style for item buttons
-    QString itemButtonStyle = QString("background-color: rgba(27,33,52,200);"
-                                  "color: white;"
-                                  "border-radius: 5px;");
-
-    // Create a secondary grid layout for small buttons
-    QGridLayout *smallItemButtonsLayout = new QGridLayout;
-
-    // Create the small buttons
-    shutDownButton = setUpItemButton("Shut Down", smallItemButtonSize, itemButtonStyle, 0, 0, smallItemButtonsLayout);
-    restartButton = setUpItemButton("Restart", smallItemButtonSize, itemButtonStyle, 0, 1, smallItemButtonsLayout);
-    sleepButton = setUpItemButton("Sleep", smallItemButtonSize, itemButtonStyle, 1, 0, smallItemButtonsLayout);
-    lockButton = setUpItemButton("Lock", smallItemButtonSize, itemButtonStyle, 1, 1, smallItemButtonsLayout);
-
-    // Connect the small buttons to their click handler
-    connect(shutDownButton, &QPushButton::clicked, this, &HomeScreen::handleShutDown);
-    connect(restartButton, &QPushButton::clicked, this, &HomeScreen::handleRestart);
-    connect(sleepButton, &QPushButton::clicked, this, &HomeScreen::handleSleep);
-    connect(lockButton, &QPushButton::clicked, this, &HomeScreen::handleLock);
-
-    // Create the large buttons
-    networkButton = setUpItemButton("WI-FI", largeItemButtonSize, itemButtonStyle, 0, 1, itemPanelLayout);
-    lightsButton = setUpItemButton("LEDs", largeItemButtonSize, itemButtonStyle, 1, 0, itemPanelLayout);
-    securityButton = setUpItemButton("Security", largeItemButtonSize, itemButtonStyle, 1, 1, itemPanelLayout);
-    remoteButton = setUpItemButton("Remote", largeItemButtonSize, itemButtonStyle, 0, 2, itemPanelLayout);
-    systemButton = setUpItemButton("System", largeItemButtonSize, itemButtonStyle, 1, 2, itemPanelLayout);
-
-    // Connect the large buttons to their click handler
-    connect(networkButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(lightsButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(securityButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(remoteButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
-    connect(systemButton, &QPushButton::clicked, this, &HomeScreen::itemButtonClicked);
+    // Status tiles in the top left 2x2 block
+    page->addTile(GetUpTile, "Get Up", 0, 0, 1, StatusGroup);
+    page->addTile(LeaveTile, "Leave", 0, 1, 1, StatusGroup);
+    page->addTile(AtHomeTile, "Home", 1, 0, 1, StatusGroup);
+    page->addTile(ToSleepTile, "Sleep", 1, 1, 1, StatusGroup);
+
+    // Large item tiles
+    page->addTile(NetworkTile, "Network", 0, 2, 2, ItemGroup);
+    page->addTile(LightsTile, "Lights", 2, 0, 2, ItemGroup);
+    page->addTile(ThermostatTile, "Thermostat", 2, 2, 2, ItemGroup);
+
+    // Set the initial status as "At Home"
+    page->select(AtHomeTile);
+}
 
-    // Set up the for the small buttons
-    smallItemButtonsLayout->setSpacing(10);
-    smallItemButtonsLayout->setContentsMargins(0, 0, 0, 0);
-    smallItemButtonsWidget->setLayout(smallItemButtonsLayout);
-
-    // Add the buttons to the grid layout
-    itemPanelLayout->addWidget(smallItemButtonsWidget, 0, 0);
+void HomeScreen::pcTiles(TileGrid *page)
+{
+    // Power tiles in the top left 2x2 block
+    page->addTile(ShutDownTile, "Shut Down", 0, 0, 1, PowerGroup);
+    page->addTile(RestartTile, "Restart", 0, 1, 1, PowerGroup);
+    page->addTile(SleepTile, "Sleep", 1, 0, 1, PowerGroup);
+    page->addTile(LockTile, "Lock", 1, 1, 1, PowerGroup);
+
+    // Large item tiles
+    page->addTile(NetworkTile, "WI-FI", 0, 2, 2, ItemGroup);
+    page->addTile(LightsTile, "LEDs", 2, 0, 2, ItemGroup);
+    page->addTile(SecurityTile, "Security", 2, 2, 2, ItemGroup);
+    page->addTile(RemoteTile, "Remote", 0, 4, 2, ItemGroup);
+    page->addTile(SystemTile, "System", 2, 4, 2, ItemGroup);
 }
 
 void HomeScreen::handleShutDown()
 {
-    QProcess::startDetached("systemctl", QStringList() << "poweroff");
+    startDetached("systemctl", QStringList() << "poweroff");
 }
 
 void HomeScreen::handleRestart()
 {
-    QProcess::startDetached("systemctl", QStringList() << "reboot");
+    startDetached("systemctl", QStringList() << "reboot");
 }
 
 void HomeScreen::handleSleep()
 {
-    QProcess::startDetached("systemctl", QStringList() << "suspend");}
+    startDetached("systemctl", QStringList() << "suspend");}
 
 void HomeScreen::handleLock()
 {
-    QProcess::startDetached("xfce4-session-logout", QStringList() << "--logout");
+    startDetached("xfce4-session-logout", QStringList() << "--logout");
 }
 
-void HomeScreen::statusButtonClicked()
+void HomeScreen::startDetached(const QString &program, const QStringList &arguments)
 {
-    // Get the button that was clicked
-    QPushButton *clickedStatusButton = qobject_cast<QPushButton*>(sender());
+    bool started = QProcess::startDetached(program, arguments);
+    CommandStats::instance()->recordDetached(CommandStats::commandKey(program, arguments), started);
+}
 
-    // Reset the style of the previously selected button
-    if (currentStatusButton)
+void HomeScreen::tileClicked(int tile)
+{
+    switch (tile)
     {
-        currentStatusButton->setStyleSheet("background-color: rgba(27,33,52,200);"
-                                           "color: white;"
-                                           "border-radius: 5px;");
+    case GetUpTile:
+    case LeaveTile:
+    case AtHomeTile:
+    case ToSleepTile:
+        // Status tiles only move the selection
+        currentPage()->select(tile);
+        break;
+    case ShutDownTile:
+        handleShutDown();
+        break;
+    case RestartTile:
+        handleRestart();
+        break;
+    case SleepTile:
+        handleSleep();
+        break;
+    case LockTile:
+        handleLock();
+        break;
+    default:
+        itemTileClicked(tile);
+        break;
     }
-
-    // Set the style of the clicked button to indicate its selection
-    clickedStatusButton->setStyleSheet("background-color: rgba(58,94,171,255);"
-                                       "color: white;"
-                                       "border-radius: 5px;");
-
-    // Update the current button
-    currentStatusButton = clickedStatusButton;
 }
 
-void HomeScreen::itemButtonClicked()
+void HomeScreen::itemTileClicked(int tile)
 {
-    // Get the button that was clicked
-    QPushButton *clickedItemButton = qobject_cast<QPushButton*>(sender());
-    if (!clickedItemButton) return;
-
-    // Update button styles
-    if (currentItemButton && currentItemButton != clickedItemButton)
-    {
-        currentItemButton->setStyleSheet("background-color: rgba(27,33,52,200); color: white; border-radius: 5px;");
-    }
-    clickedItemButton->setStyleSheet("background-color: rgba(58,94,171,255); color: white; border-radius: 5px;");
-    currentItemButton = clickedItemButton;
+    StallWatchdog::Scope stallScope("HomeScreen::itemTileClicked");
+    TRACE_SCOPE("HomeScreen::itemTileClicked");
 
-    // Clear and prepare the option panel
-    clearOptionPanelLayout();
+    // Update tile selection
+    currentPage()->select(tile);
 
-    // Determine which control to show
+    // Determine which control to show, the registry hands out the same instance every time
     QWidget *controlWidget = nullptr;
-    if (clickedItemButton == networkButton)
+    if (tile == NetworkTile)
     {
-        controlWidget = new NetworkControls(this);
-        static_cast<NetworkControls*>(controlWidget)->setActive(true);
+        controlWidget = controls->activate(ControlRegistry::Network);
     }
-    else if (clickedItemButton == securityButton)
+    else if (tile == SecurityTile)
     {
-        controlWidget = new SecurityControls(this);
+        controlWidget = controls->activate(ControlRegistry::Security);
     }
 
-    // If a control widget was created, show it in the option panel
+    // If there is a control for the tile, show it in the option panel
     if (controlWidget)
     {
-        optionPanelLayout->addWidget(controlWidget);
-
         // Position and animate the panel
         QRect startGeometry(optionPanel->x(), centralWidget->height(),
                             optionPanel->width(), optionPanel->height());
         QRect endGeometry(optionPanel->x(), centralWidget->height() - optionPanel->height(),
                           optionPanel->width(), optionPanel->height());
 
-        optionPanel->setGeometry(startGeometry);
-        optionPanel->show();
+        // Lay the panel out where it ends up, picture it and slide the picture in
+        optionPanelAnimation->stop();
+        optionPanelSnapshot->release();
+        optionPanel->setGeometry(endGeometry);
+        beginPanelMotion(startGeometry.topLeft());
         animatePanel(endGeometry);
     }
     else
     {
-        // If no control widget was created, hide the panel
+        // If the tile has no control, hide the panel
+        optionPanelAnimation->stop();
+        optionPanelSnapshot->release();
         optionPanel->hide();
+        optionPanelHandle->hide();
 
-        // Deactivate any existing NetworkControls
-        NetworkControls *existingNetworkControls = optionPanel->findChild<NetworkControls*>();
-        if (existingNetworkControls)
-        {
-            existingNetworkControls->setActive(false);
-        }
+        // Stop the shown control's probes
+        controls->deactivate();
     }
 }
 
@@ -768,92 +861,100 @@ void HomeScreen::swipePanelDown()
         animatePanel(endGeometry);
     }
 
-    // Deactivate any existing NetworkControls
-    NetworkControls *existingNetworkControls = optionPanel->findChild<NetworkControls*>();
-    if (existingNetworkControls)
-    {
-        existingNetworkControls->setActive(false);
-    }
+    // Stop the shown control's probes
+    controls->deactivate();
 }
 
-void HomeScreen::mousePressEvent(QMouseEvent *event)
+void HomeScreen::panelSwipeStarted()
 {
-    if (optionPanel->isVisible())
-    {
-        // Define the drag area
-        QRect dragArea(optionPanel->x(), optionPanel->y(), optionPanel->width(), 80);
+    // The handle stays on top of the picture so it keeps the rest of the swipe
+    beginPanelMotion(optionPanel->pos());
+    optionPanelHandle->raise();
+}
 
-        // Start dragging if the mouse press is within the drag area
-        if (dragArea.contains(event->pos()))
-        {
-            isDragging = true;
-            dragStartPosition = event->pos();
-        }
-    }
-    QMainWindow::mousePressEvent(event);
+void HomeScreen::panelSwipeMoved(int deltaY)
+{
+    // Only downwards from the open position
+    const int openTop = height() - optionPanel->height();
+    QPoint position(optionPanel->x(), qBound(openTop, openTop + deltaY, height()));
+
+    optionPanelSnapshot->move(position);
+    placePanelHandle(position);
 }
 
-void HomeScreen::mouseMoveEvent(QMouseEvent *event)
+void HomeScreen::panelSwipeFinished(int deltaY, qreal velocity)
 {
-    if (isDragging)
+    // A fast flick closes the panel, a slow drag only does past a third of its height
+    const bool close = velocity > PanelFlingVelocity ||
+                       (velocity > -PanelFlingVelocity && deltaY > optionPanel->height() / 3);
+
+    QRect endGeometry;
+    if (close)
     {
-        int deltaY = event->pos().y() - dragStartPosition.y();
-        if (deltaY >= 0) // Only allow dragging downwards
-        {
-            // Move the option panel based on the drag distance
-            QRect geometry = optionPanel->geometry();
-            geometry.moveTop(qMin(height() - optionPanel->height() + deltaY, height()));
-            optionPanel->setGeometry(geometry);
-        }
+        endGeometry = QRect(optionPanel->x(), height(),
+                            optionPanel->width(), optionPanel->height());
+
+        // Stop the shown control's probes
+        controls->deactivate();
     }
-    QMainWindow::mouseMoveEvent(event);
+    else
+    {
+        // Return to original position
+        endGeometry = QRect(optionPanel->x(), height() - optionPanel->height(),
+                            optionPanel->width(), optionPanel->height());
+    }
+
+    animatePanel(endGeometry);
 }
 
-void HomeScreen::mouseReleaseEvent(QMouseEvent *event)
+void HomeScreen::placePanelHandle(const QPoint &panelPosition)
 {
-    if (isDragging)
-    {
-        isDragging = false;
-        int deltaY = event->pos().y() - dragStartPosition.y();
+    optionPanelHandle->setGeometry(panelPosition.x(), panelPosition.y(), optionPanel->width(), PanelHandleHeight);
+}
 
-        QRect endGeometry;
-        if (deltaY > dragThreshold)
-        {
-            // Close the panel if dragged far enough and released
-            endGeometry = QRect(optionPanel->x(), height(),
-                                optionPanel->width(), optionPanel->height());
-
-            // Deactivate any existing NetworkControls
-            NetworkControls *existingNetworkControls = optionPanel->findChild<NetworkControls*>();
-            if (existingNetworkControls)
-            {
-                existingNetworkControls->setActive(false);
-            }
-        }
-        else
-        {
-            // Return to original position if not dragged and released far enough
-            endGeometry = QRect(optionPanel->x(), height() - optionPanel->height(),
-                                optionPanel->width(), optionPanel->height());
-        }
+void HomeScreen::animatePanel(const QRect &endValue)
+{
+    // Slide the picture of the panel, the live panel is put back when the animation finishes
+    beginPanelMotion(optionPanel->pos());
+    optionPanelHandle->hide();
+    optionPanelAnimation->stop();
+    optionPanelAnimation->setStartValue(optionPanelSnapshot->pos());
+    optionPanelAnimation->setEndValue(endValue.topLeft());
+    optionPanelAnimation->start();
+}
 
-        animatePanel(endGeometry);
+void HomeScreen::beginPanelMotion(const QPoint &from)
+{
+    // Already moving, keep the picture taken at the start
+    if (optionPanelSnapshot->isVisible())
+    {
+        return;
     }
-    QMainWindow::mouseReleaseEvent(event);
+
+    optionPanelSnapshot->capture(optionPanel, from);
+    optionPanel->hide();
 }
 
-void HomeScreen::animatePanel(const QRect &endValue)
+void HomeScreen::endPanelMotion()
 {
-    // Set up the option panel animation
-    optionPanelAnimation->setStartValue(optionPanel->geometry());
-    optionPanelAnimation->setEndValue(endValue);
-    optionPanelAnimation->start();
+    // Show the live panel where the picture stopped, unless it slid off screen
+    const QPoint position = optionPanelSnapshot->pos();
+    if (position.y() < height())
+    {
+        optionPanel->move(position);
+        optionPanel->show();
+
+        placePanelHandle(position);
+        optionPanelHandle->show();
+        optionPanelHandle->raise();
+    }
 
-    // If panel is closing, hide it when the animation finishes
-    if (endValue.y() >= height())
+    // Frame times are only printed while the run is being profiled
+    PanelSnapshot::FrameStats stats = optionPanelSnapshot->release();
+    if (stats.frames > 0 && Trace::isEnabled())
     {
-        connect(optionPanelAnimation, &QPropertyAnimation::finished, this, [this]() {
-            optionPanel->hide();
-        }, Qt::SingleShotConnection);
+        qDebug() << "Option panel motion:" << stats.frames << "frames, mean"
+                 << QString::number(stats.totalNs / 1e6 / stats.frames, 'f', 1) << "ms, worst"
+                 << QString::number(stats.worstNs / 1e6, 'f', 1) << "ms";
     }
 }
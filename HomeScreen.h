@@ -1,8 +1,6 @@
 #ifndef HOMESCREEN_H
 #define HOMESCREEN_H
 
-#include "NetworkControls.h"
-#include "SecurityControls.h"
 #include "Weather.h"
 
 #include <QMainWindow>
@@ -10,9 +8,23 @@
 #include <QLabel>
 #include <QTimer>
 #include <QHBoxLayout>
+#include <QVBoxLayout>
 #include <QPushButton>
-#include <QGridLayout>
 #include <QPropertyAnimation>
+#include <QStackedWidget>
+#include <QHash>
+#include <QList>
+#include <QTime>
+#include <QDate>
+
+class ControlRegistry;
+class DetailView;
+class IdleMonitor;
+class MinuteClock;
+class PanelSnapshot;
+class StaticTextLabel;
+class SwipeGesture;
+class TileGrid;
 
 class HomeScreen : public QMainWindow
 {
@@ -26,18 +38,26 @@ protected:
     // Event handlers
     void resizeEvent(QResizeEvent *event) override;
     bool eventFilter(QObject *watched, QEvent *event) override;
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void mouseReleaseEvent(QMouseEvent *event) override;
 
 private slots:
-    // Slot to update the time display
-    void updateTime();
+    // Slots to update the time and date display
+    void updateTime(const QTime &time);
+    void updateDate(const QDate &date);
 
-    // Button click handlers
+    // Show the weather snapshot, marked when it is stale
+    void showWeather();
+
+    // Blank the screen and stop polling while nobody uses the panel
+    void idleChanged(bool idle);
+
+    // Button and tile click handlers
     void areaButtonClicked();
-    void statusButtonClicked();
-    void itemButtonClicked();
+    void tileClicked(int tile);
+
+    // Option panel swipe handlers
+    void panelSwipeStarted();
+    void panelSwipeMoved(int deltaY);
+    void panelSwipeFinished(int deltaY, qreal velocity);
 
     // PC control handlers
     void handleShutDown();
@@ -53,34 +73,46 @@ private:
     void setUpItemPanel();
     void setUpWeatherPanel();
     void setUpOptionPanel();
-    void clearOptionPanelLayout();
-    void allDevicesButtons();
-    void pcButtons();
+    void setUpDebugOverlay();
+    void setUpIdleMode();
+    void allDevicesTiles(TileGrid *page);
+    void pcTiles(TileGrid *page);
 
     // Helper methods
-    void updateWeatherPanel(const QString &condition, const QString &temperature, const QString &apparenttemperature, double windSpeedVal, double windDirVal);
+    void updateWeatherPanel(WeatherCondition condition, const QString &temperature, const QString &apparenttemperature, double windSpeedVal, double windDirVal);
     void adjustFontSizes();
-    QPushButton* setUpItemButton(const QString &text, const QSize &size, const QString &style, int row, int col, QGridLayout *layout);
+    void itemTileClicked(int tile);
+
+    // Item panel page of an area, built on first use and kept until evicted
+    QWidget *areaPage(QPushButton *areaButton);
+    QWidget *devicePage(const QString &room); // every room when empty
+    TileGrid *currentPage() const; // null on device pages
+    void trimAreaPages(int keep);
     void animatePanel(const QRect &endValue);
+    void beginPanelMotion(const QPoint &from);
+    void endPanelMotion();
+    void placePanelHandle(const QPoint &panelPosition);
     void swipePanelDown();
+    void startDetached(const QString &program, const QStringList &arguments);
 
     // Main widgets
     QWidget *centralWidget;
     QWidget *topPanel;
     QWidget *areaPanel;
-    QWidget *itemPanel;
+    QStackedWidget *itemPanel;
     QWidget *weatherPanel;
     QWidget *optionPanel;
+    PanelSnapshot *optionPanelSnapshot; // moved in place of the panel during slides and drags
+    QWidget *optionPanelHandle;         // strip along the top of the panel that takes swipes
+    SwipeGesture *optionPanelSwipe;
 
     // Top panel labels
     QLabel *titleLabel;
-    QLabel *timeLabel;
-    QLabel *dateLabel;
+    StaticTextLabel *timeLabel;
+    StaticTextLabel *dateLabel;
 
-    // Timers
-    QTimer *timer;
-    QTimer *weatherTimer;
     Weather *weather;
+    MinuteClock *clock;
 
     // Area buttons
     QPushButton *allDevicesButton;
@@ -90,34 +122,47 @@ private:
 
     // Layouts
     QHBoxLayout *areaPanelLayout;
-    QGridLayout *itemPanelLayout;
     QVBoxLayout *weatherPanelLayout;
     QVBoxLayout *optionPanelLayout;
 
-    // Current selected buttons
+    // Current selected area button
     QPushButton *currentAreaButton;
-    QPushButton *currentStatusButton;
-    QPushButton *currentItemButton;
-
-    // Status buttons
-    QPushButton *getUpButton;
-    QPushButton *leaveButton;
-    QPushButton *atHomeButton;
-    QPushButton *toSleepButton;
-
-    // Item buttons
-    QPushButton *networkButton;
-    QPushButton *lightsButton;
-    QPushButton *thermostatButton;
-    QPushButton *securityButton;
-    QPushButton *remoteButton;
-    QPushButton *systemButton;
-
-    // PC power buttons
-    QPushButton *shutDownButton;
-    QPushButton *restartButton;
-    QPushButton *lockButton;
-    QPushButton *sleepButton;
+
+    // Built item panel pages, least recently shown first
+    QHash<QPushButton *, QWidget *> areaPages;
+    QList<QPushButton *> areaPageOrder;
+
+    // Item panel tiles
+    enum Tile
+    {
+        // Status tiles
+        GetUpTile,
+        LeaveTile,
+        AtHomeTile,
+        ToSleepTile,
+
+        // Item tiles
+        NetworkTile,
+        LightsTile,
+        ThermostatTile,
+        SecurityTile,
+        RemoteTile,
+        SystemTile,
+
+        // PC power tiles
+        ShutDownTile,
+        RestartTile,
+        SleepTile,
+        LockTile
+    };
+
+    // Selection is exclusive within a group
+    enum TileGroup
+    {
+        StatusGroup,
+        ItemGroup,
+        PowerGroup
+    };
 
     // Weather labels
     QLabel *weatherConditionLabel;
@@ -126,17 +171,19 @@ private:
     QLabel *weatherWindLabel;
     QLabel *weatherIconLabel;
 
-    // Control widgets
-    NetworkControls *networkControls;
-    SecurityControls *securityControls;
-
-    // Drag variables
-    bool isDragging;
-    QPoint dragStartPosition;
-    int dragThreshold;
+    // Option panel controls, one long-lived instance each
+    ControlRegistry *controls;
 
     // Animations
     QPropertyAnimation *optionPanelAnimation;
+
+    // Debug overlay
+    DetailView *commandStatsOverlay;
+    int commandStatsProbe;
+
+    // Idle mode
+    IdleMonitor *idleMonitor;
+    QWidget *idleOverlay;
 };
 
 #endif // HOMESCREEN_H
@@ -1,4 +1,6 @@
-QT       += core gui network
+QT       += core gui network dbus concurrent
+
+lessThan(QT_MAJOR_VERSION, 6): error("HomeScreen needs Qt 6, found Qt $$QT_VERSION")
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,19 +11,73 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    CommandStats.cpp \
+    ControlRegistry.cpp \
+    DetailView.cpp \
+    DeviceModel.cpp \
+    DeviceRegistry.cpp \
+    DeviceTileDelegate.cpp \
+    FirstFrameTimer.cpp \
     HomeScreen.cpp \
+    IconCache.cpp \
+    IdleMonitor.cpp \
+    MinuteClock.cpp \
     Main.cpp \
     NetworkControls.cpp \
+    NetworkManagerWatcher.cpp \
+    PanelSnapshot.cpp \
+    ProbeEngine.cpp \
+    ProbeScheduler.cpp \
+    SecurityCollectors.cpp \
     SecurityControls.cpp \
+    SocketTable.cpp \
+    StallWatchdog.cpp \
+    StaticTextLabel.cpp \
+    SwipeGesture.cpp \
+    SystemBus.cpp \
+    SystemdUnitWatcher.cpp \
+    Theme.cpp \
+    TileGrid.cpp \
     ToggleButton.cpp \
-    Weather.cpp
+    Trace.cpp \
+    Weather.cpp \
+    WeatherCache.cpp \
+    WeatherSnapshot.cpp \
+    WifiReader.cpp
 
 HEADERS += \
+    CommandStats.h \
+    ControlRegistry.h \
+    DetailView.h \
+    DeviceModel.h \
+    DeviceRegistry.h \
+    DeviceTileDelegate.h \
+    FirstFrameTimer.h \
     HomeScreen.h \
+    IconCache.h \
+    IdleMonitor.h \
+    MinuteClock.h \
     NetworkControls.h \
+    NetworkManagerWatcher.h \
+    PanelSnapshot.h \
+    ProbeEngine.h \
+    ProbeScheduler.h \
+    SecurityCollectors.h \
     SecurityControls.h \
+    SocketTable.h \
+    StallWatchdog.h \
+    StaticTextLabel.h \
+    SwipeGesture.h \
+    SystemBus.h \
+    SystemdUnitWatcher.h \
+    Theme.h \
+    TileGrid.h \
     ToggleButton.h \
-    Weather.h
+    Trace.h \
+    Weather.h \
+    WeatherCache.h \
+    WeatherSnapshot.h \
+    WifiReader.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,180 @@
+#include "IconCache.h"
+#include "Trace.h"
+#include "ProbeScheduler.h"
+
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QPainter>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+qint64 pixmapBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+} // namespace
+
+bool IconCache::Key::operator==(const Key &other) const
+{
+    return source == other.source && size == other.size && tint == other.tint &&
+           qFuzzyCompare(devicePixelRatio, other.devicePixelRatio);
+}
+
+size_t qHash(const IconCache::Key &key, size_t seed)
+{
+    return qHashMulti(seed, key.source, key.size.width(), key.size.height(), key.tint,
+                      qRound(key.devicePixelRatio * 100));
+}
+
+IconCache *IconCache::instance()
+{
+    static IconCache *cache = new IconCache(qApp);
+    return cache;
+}
+
+IconCache::IconCache(QObject *parent)
+    : QObject(parent),
+    useCount(0)
+{
+}
+
+void IconCache::prewarm(const QList<Key> &keys)
+{
+    QList<Key> missing;
+    for (const Key &key : keys)
+    {
+        if (!entries.contains(key) && !missing.contains(key))
+        {
+            missing.append(key);
+        }
+    }
+    if (missing.isEmpty())
+    {
+        return;
+    }
+
+    QFutureWatcher<QList<QImage>> *watcher = new QFutureWatcher<QList<QImage>>(this);
+    connect(watcher, &QFutureWatcher<QList<QImage>>::finished, this, [this, watcher, missing]() {
+        const QList<QImage> images = watcher->result();
+        watcher->deleteLater();
+
+        for (int i = 0; i < missing.size(); ++i)
+        {
+            const Key &key = missing.at(i);
+            if (entries.contains(key))
+            {
+                continue;
+            }
+
+            // Uploading to a pixmap has to happen on the GUI thread. Unreadable
+            // sources are kept as null pixmaps so they are not retried on every update.
+            Entry entry;
+            if (!images.at(i).isNull())
+            {
+                entry.pixmap = QPixmap::fromImage(images.at(i));
+                entry.pixmap.setDevicePixelRatio(key.devicePixelRatio);
+            }
+            entries.insert(key, entry);
+        }
+        emit prewarmed();
+    });
+    watcher->setFuture(QtConcurrent::run(ProbeScheduler::instance()->workerPool(), &IconCache::renderAll, missing));
+}
+
+QPixmap IconCache::pixmap(const Key &key)
+{
+    auto it = entries.find(key);
+    if (it != entries.end())
+    {
+        it->lastUsed = ++useCount;
+        return it->pixmap;
+    }
+
+    // Not prewarmed (yet), render just this one
+    Entry entry;
+    entry.pixmap = QPixmap::fromImage(render(key));
+    entry.pixmap.setDevicePixelRatio(key.devicePixelRatio);
+    entry.lastUsed = ++useCount;
+    entries.insert(key, entry);
+    return entry.pixmap;
+}
+
+void IconCache::trim(qint64 budgetBytes)
+{
+    qint64 total = cachedBytes();
+    if (total <= budgetBytes)
+    {
+        return;
+    }
+
+    // Oldest first; prewarmed icons that were never shown count as used at 0
+    QList<QPair<quint64, Key>> byAge;
+    byAge.reserve(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        byAge.append(qMakePair(it->lastUsed, it.key()));
+    }
+    std::sort(byAge.begin(), byAge.end(), [](const QPair<quint64, Key> &a, const QPair<quint64, Key> &b) {
+        return a.first < b.first;
+    });
+
+    for (const QPair<quint64, Key> &oldest : byAge)
+    {
+        if (total <= budgetBytes)
+        {
+            break;
+        }
+        total -= pixmapBytes(entries.value(oldest.second).pixmap);
+        entries.remove(oldest.second);
+    }
+}
+
+qint64 IconCache::cachedBytes() const
+{
+    qint64 total = 0;
+    for (const Entry &entry : entries)
+    {
+        total += pixmapBytes(entry.pixmap);
+    }
+    return total;
+}
+
+QImage IconCache::render(const Key &key)
+{
+    QImage source(key.source);
+    if (source.isNull())
+    {
+        qDebug() << "Icon not found at:" << key.source;
+        return QImage();
+    }
+
+    // Scale first so the recolouring only touches the final pixels
+    const QSize pixelSize = key.size * key.devicePixelRatio;
+    QImage scaled = source.convertToFormat(QImage::Format_ARGB32_Premultiplied)
+                        .scaled(pixelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    // Keep the alpha of the icon, replace its colour with the tint
+    QPainter painter(&scaled);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(scaled.rect(), QColor::fromRgba(key.tint));
+    painter.end();
+    return scaled;
+}
+
+QList<QImage> IconCache::renderAll(const QList<Key> &keys)
+{
+    TRACE_SCOPE("IconCache::renderAll");
+
+    QList<QImage> images;
+    images.reserve(keys.size());
+    for (const Key &key : keys)
+    {
+        images.append(render(key));
+    }
+    return images;
+}
@@ -0,0 +1,69 @@
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QImage>
+#include <QRgb>
+#include <QSize>
+#include <QString>
+
+// Tinted, scaled icons rendered once and kept until trim() needs the memory.
+// prewarm() decodes, recolours and scales a set of icons on a worker thread;
+// afterwards pixmap() is a hash lookup that returns an implicitly shared pixmap.
+class IconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Key
+    {
+        QString source;              // image file
+        QSize size;                  // logical size, the aspect ratio is kept
+        QRgb tint = qRgb(255, 255, 255);
+        qreal devicePixelRatio = 1.0;
+
+        bool operator==(const Key &other) const;
+    };
+
+    // Shared by all widgets, owned by the application
+    static IconCache *instance();
+
+    // Render the given icons in the background, keys already cached are skipped
+    void prewarm(const QList<Key> &keys);
+
+    // The cached icon, rendered on the spot (and cached) if prewarm has not got to it yet.
+    // A null pixmap means the source could not be read.
+    QPixmap pixmap(const Key &key);
+
+    // Drop the least recently used icons until what is cached fits the budget.
+    // Pixmaps still held by widgets stay alive through their own copies.
+    void trim(qint64 budgetBytes);
+    qint64 cachedBytes() const;
+
+signals:
+    // Emitted on the GUI thread when a prewarm batch has been added
+    void prewarmed();
+
+private:
+    explicit IconCache(QObject *parent = nullptr);
+
+    struct Entry
+    {
+        QPixmap pixmap;
+        quint64 lastUsed = 0; // useCount at the last pixmap() call
+    };
+
+    // Thread-safe, only uses QImage
+    static QImage render(const Key &key);
+    static QList<QImage> renderAll(const QList<Key> &keys);
+
+    QHash<Key, Entry> entries;
+    quint64 useCount;
+};
+
+size_t qHash(const IconCache::Key &key, size_t seed = 0);
+
+#endif // ICONCACHE_H
@@ -0,0 +1,262 @@
+#include "IdleMonitor.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QWindow>
+#include <QDebug>
+
+namespace {
+
+// Share of the maximum brightness kept while idle
+const int DimmedPercent = 10;
+
+QByteArray readValue(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+    return file.readAll().trimmed();
+}
+
+bool writeValue(const QString &path, const QByteArray &value)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(value) == value.size();
+}
+
+} // namespace
+
+// Constructor
+IdleMonitor::IdleMonitor(QWindow *window, int idleAfterMs, QObject *parent)
+    : QObject(parent),
+    window(window),
+    idleAfterMs(idleAfterMs),
+    idle(false),
+    swallowing(false),
+    sampledSwitches(contextSwitches()),
+    backlight(qEnvironmentVariable("HOMESCREEN_BACKLIGHT"))
+{
+    sampleClock.start();
+    lastInput.start();
+
+    // A second late does not matter for a timeout in minutes
+    idleTimer.setSingleShot(true);
+    idleTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&idleTimer, &QTimer::timeout, this, &IdleMonitor::checkIdle);
+
+    window->installEventFilter(this);
+    if (idleAfterMs > 0)
+    {
+        idleTimer.start(idleAfterMs);
+    }
+}
+
+// Destructor
+IdleMonitor::~IdleMonitor()
+{
+    // Never leave the display dark
+    if (idle)
+    {
+        setBacklight(false);
+    }
+}
+
+int IdleMonitor::idleAfterFromEnvironment()
+{
+    bool ok = false;
+    int minutes = qEnvironmentVariableIntValue("HOMESCREEN_IDLE_MINUTES", &ok);
+    return (ok ? minutes : 5) * 60 * 1000;
+}
+
+bool IdleMonitor::isIdle() const
+{
+    return idle;
+}
+
+qreal IdleMonitor::activeWakeupsPerMinute() const
+{
+    const Usage active = usage(Active);
+    return active.ms > 0 ? active.wakeups * 60000.0 / active.ms : -1;
+}
+
+qreal IdleMonitor::idleWakeupsPerMinute() const
+{
+    const Usage idleUsage = usage(Idle);
+    return idleUsage.ms > 0 ? idleUsage.wakeups * 60000.0 / idleUsage.ms : -1;
+}
+
+QStringList IdleMonitor::summaryLines() const
+{
+    auto rate = [](qreal perMinute) {
+        return perMinute < 0 ? QString("-") : QString::number(perMinute, 'f', 1);
+    };
+
+    return QStringList()
+           << QString("Wakeups per minute: %1 active, %2 idle")
+                  .arg(rate(activeWakeupsPerMinute()))
+                  .arg(rate(idleWakeupsPerMinute()));
+}
+
+bool IdleMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched != window)
+    {
+        return false;
+    }
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::TouchBegin:
+    case QEvent::KeyPress:
+    case QEvent::Wheel:
+        lastInput.start();
+        if (idle)
+        {
+            setIdle(false);
+            swallowing = event->type() == QEvent::MouseButtonPress || event->type() == QEvent::TouchBegin;
+            event->accept();
+            return true;
+        }
+        return false;
+    case QEvent::MouseMove:
+    case QEvent::TouchUpdate:
+        lastInput.start();
+        return swallowing;
+    case QEvent::MouseButtonRelease:
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel:
+        lastInput.start();
+        if (swallowing)
+        {
+            swallowing = false;
+            event->accept();
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+void IdleMonitor::checkIdle()
+{
+    // Input since the timer was armed only moved the deadline
+    const qint64 quiet = lastInput.elapsed();
+    if (quiet < idleAfterMs)
+    {
+        idleTimer.start(int(idleAfterMs - quiet));
+        return;
+    }
+    setIdle(true);
+}
+
+void IdleMonitor::setIdle(bool isIdle)
+{
+    TRACE_SCOPE("IdleMonitor::setIdle");
+
+    if (idle == isIdle)
+    {
+        return;
+    }
+
+    sample();
+    idle = isIdle;
+    setBacklight(idle);
+
+    // Nothing to time while idle, the next input re-arms the check
+    if (idle)
+    {
+        idleTimer.stop();
+    }
+    else if (idleAfterMs > 0)
+    {
+        idleTimer.start(idleAfterMs);
+    }
+
+    emit idleChanged(idle);
+
+    // The debug overlay shows the same numbers, the log only gets them while tracing
+    if (Trace::isEnabled())
+    {
+        qDebug().noquote() << (idle ? "Idle." : "Active.") << summaryLines().join(' ');
+    }
+}
+
+void IdleMonitor::sample()
+{
+    const quint64 switches = contextSwitches();
+    Usage &current = totals[idle ? Idle : Active];
+    current.ms += sampleClock.restart();
+
+    // Threads that exited take their counts with them
+    current.wakeups += switches > sampledSwitches ? switches - sampledSwitches : 0;
+    sampledSwitches = switches;
+}
+
+IdleMonitor::Usage IdleMonitor::usage(State state) const
+{
+    Usage result = totals[state];
+    if ((state == Idle) == idle)
+    {
+        // The state we are in is counted up to now
+        const quint64 switches = contextSwitches();
+        result.ms += sampleClock.elapsed();
+        result.wakeups += switches > sampledSwitches ? switches - sampledSwitches : 0;
+    }
+    return result;
+}
+
+quint64 IdleMonitor::contextSwitches()
+{
+    // Every thread of the process blocks and is woken separately
+    quint64 total = 0;
+    const QStringList threads = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &thread : threads)
+    {
+        QFile status("/proc/self/task/" + thread + "/status");
+        if (!status.open(QIODevice::ReadOnly))
+        {
+            continue;
+        }
+        const QList<QByteArray> lines = status.readAll().split('\n');
+        for (const QByteArray &line : lines)
+        {
+            if (line.startsWith("voluntary_ctxt_switches:"))
+            {
+                total += line.mid(line.indexOf(':') + 1).trimmed().toULongLong();
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+void IdleMonitor::setBacklight(bool dimmed)
+{
+    if (backlight.isEmpty())
+    {
+        return;
+    }
+
+    const QString brightnessPath = QDir(backlight).filePath("brightness");
+    if (dimmed)
+    {
+        brightness = readValue(brightnessPath);
+        const int maximum = readValue(QDir(backlight).filePath("max_brightness")).toInt();
+        if (brightness.isEmpty() || maximum <= 0)
+        {
+            qDebug() << "No backlight to dim at" << backlight;
+            return;
+        }
+        writeValue(brightnessPath, QByteArray::number(qMax(1, maximum * DimmedPercent / 100)));
+    }
+    else if (!brightness.isEmpty())
+    {
+        writeValue(brightnessPath, brightness);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef IDLEMONITOR_H
+#define IDLEMONITOR_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+class QWindow;
+
+// Tells when nobody has touched the panel for a while. Only the input events of
+// one window are looked at, each one just restarts a clock; a single timer
+// checks that clock when the timeout could have run out. The touch that ends
+// idle is swallowed up to its release, so waking the panel does not also press
+// whatever was under the finger.
+//
+// Wakeups are measured as voluntary context switches of the process, summed
+// over its threads, and reported per minute for the active and idle states.
+// When HOMESCREEN_BACKLIGHT names a sysfs backlight directory it is dimmed
+// while idle.
+class IdleMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // idleAfterMs of 0 or less never goes idle, wakeups are still measured
+    IdleMonitor(QWindow *window, int idleAfterMs, QObject *parent = nullptr);
+    ~IdleMonitor();
+
+    // HOMESCREEN_IDLE_MINUTES in ms, 5 minutes when unset
+    static int idleAfterFromEnvironment();
+
+    bool isIdle() const;
+
+    // Wakeups per minute so far in each state, -1 where nothing was measured
+    qreal activeWakeupsPerMinute() const;
+    qreal idleWakeupsPerMinute() const;
+
+    // Lines for the debug overlay
+    QStringList summaryLines() const;
+
+signals:
+    void idleChanged(bool idle);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void checkIdle();
+
+private:
+    enum State
+    {
+        Active,
+        Idle,
+        StateCount
+    };
+
+    struct Usage
+    {
+        qint64 ms = 0;
+        quint64 wakeups = 0;
+    };
+
+    void setIdle(bool idle);
+
+    // Add what was used since the last sample to the current state
+    void sample();
+    Usage usage(State state) const;
+    static quint64 contextSwitches();
+
+    void setBacklight(bool dimmed);
+
+    QWindow *window;
+    const int idleAfterMs;
+    QTimer idleTimer;
+    QElapsedTimer lastInput;
+    bool idle;
+    bool swallowing; // eat the waking touch up to its release
+
+    Usage totals[StateCount];
+    QElapsedTimer sampleClock;
+    quint64 sampledSwitches;
+
+    QString backlight;       // sysfs directory, empty when not dimming
+    QByteArray brightness;   // value to restore
+};
+
+#endif // IDLEMONITOR_H
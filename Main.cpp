@@ -1,13 +1,35 @@
 #include "HomeScreen.h"
+#include "FirstFrameTimer.h"
+#include "StallWatchdog.h"
+#include "Theme.h"
+#include "Trace.h"
 #include <QApplication>
 #include <QScreen>
 
 int main(int argc, char *argv[])
 {
+    // Opt-in, set HOMESCREEN_TRACE to the file that gets a Chrome trace of the run
+    Trace::startFromEnvironment();
+    Trace::instant("main");
+
     QApplication app(argc, argv);
+    Trace::instant("QApplication created");
+
+    // Opt-in, set HOMESCREEN_STALL_WATCHDOG to the stall threshold in ms
+    StallWatchdog::startFromEnvironment();
+
+    // One style sheet for every widget, parsed once
+    Theme::apply(&app);
+
     HomeScreen homescreen;
     homescreen.resize(2000, 1200);
     homescreen.setMinimumSize(1000, 600);
     homescreen.move(QGuiApplication::primaryScreen()->geometry().center() - homescreen.rect().center());
-    return app.exec();
+
+    // Opt-in, set HOMESCREEN_EXIT_AFTER_FIRST_FRAME to time startup and quit
+    FirstFrameTimer::watchFromEnvironment(&homescreen);
+
+    int result = app.exec();
+    Trace::exportTo();
+    return result;
 }
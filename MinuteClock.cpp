@@ -0,0 +1,175 @@
+#include "MinuteClock.h"
+#include "Trace.h"
+
+#include <QDateTime>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <sys/timerfd.h>
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const qint64 MinuteMs = 60 * 1000;
+
+} // namespace
+
+// Constructor
+MinuteClock::MinuteClock(QObject *parent)
+    : QObject(parent),
+    timerFd(-1),
+    notifier(nullptr),
+    nextMidnight(0),
+    wakeupCount(0),
+    clockJumps(0)
+{
+#ifdef Q_OS_LINUX
+    timerFd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd >= 0)
+    {
+        notifier = new QSocketNotifier(timerFd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &MinuteClock::wake);
+    }
+#endif
+
+    // Relative and monotonic, only used where there is no timerfd
+    fallbackTimer.setSingleShot(true);
+    fallbackTimer.setTimerType(Qt::PreciseTimer);
+    connect(&fallbackTimer, &QTimer::timeout, this, &MinuteClock::wake);
+}
+
+// Destructor
+MinuteClock::~MinuteClock()
+{
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0)
+    {
+        delete notifier;
+        ::close(timerFd);
+    }
+#endif
+}
+
+void MinuteClock::start()
+{
+    if (!running.isValid())
+    {
+        running.start();
+    }
+    currentMinute = QTime();
+    currentDate = QDate();
+    update(true);
+    schedule();
+}
+
+void MinuteClock::stop()
+{
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0)
+    {
+        // A zero expiry disarms the timer
+        itimerspec spec = {};
+        timerfd_settime(timerFd, 0, &spec, nullptr);
+    }
+#endif
+    fallbackTimer.stop();
+}
+
+quint64 MinuteClock::wakeups() const
+{
+    return wakeupCount;
+}
+
+qreal MinuteClock::wakeupsPerHour() const
+{
+    if (!running.isValid() || running.elapsed() <= 0)
+    {
+        return 0;
+    }
+    return wakeupCount * 3600000.0 / running.elapsed();
+}
+
+QStringList MinuteClock::summaryLines() const
+{
+    return QStringList()
+           << QString("Clock wakeups: %1, %2 per hour, wall clock jumps %3")
+                  .arg(wakeupCount)
+                  .arg(wakeupsPerHour(), 0, 'f', 1)
+                  .arg(clockJumps);
+}
+
+void MinuteClock::wake()
+{
+    TRACE_SCOPE("MinuteClock::wake");
+
+    ++wakeupCount;
+    bool clockJumped = false;
+
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0)
+    {
+        // ECANCELED means the wall clock was set while we were waiting
+        quint64 expirations = 0;
+        if (::read(timerFd, &expirations, sizeof(expirations)) < 0 && errno == ECANCELED)
+        {
+            clockJumped = true;
+        }
+    }
+#endif
+
+    if (clockJumped)
+    {
+        ++clockJumps;
+    }
+    update(clockJumped);
+    schedule();
+}
+
+void MinuteClock::update(bool clockJumped)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QDateTime local = QDateTime::fromMSecsSinceEpoch(now);
+
+    const QTime time = local.time();
+    const QTime minute(time.hour(), time.minute());
+    if (minute != currentMinute)
+    {
+        currentMinute = minute;
+        emit minuteChanged(minute);
+    }
+
+    if (clockJumped || now >= nextMidnight)
+    {
+        const QDate date = local.date();
+        nextMidnight = QDateTime(date.addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+        if (date != currentDate)
+        {
+            currentDate = date;
+            emit dateChanged(date);
+        }
+    }
+}
+
+void MinuteClock::schedule()
+{
+    // Minute boundaries are the same in UTC and in every zone with a whole-minute offset
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 next = (now / MinuteMs + 1) * MinuteMs;
+
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0)
+    {
+        itimerspec spec = {};
+        spec.it_value.tv_sec = next / 1000;
+        if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) == 0)
+        {
+            return;
+        }
+    }
+#endif
+
+    // Does not follow suspends or clock changes, but is re-aimed at the boundary on every wakeup
+    fallbackTimer.start(int(next - now));
+}
@@ -0,0 +1,64 @@
+#ifndef MINUTECLOCK_H
+#define MINUTECLOCK_H
+
+#include <QObject>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTime>
+#include <QTimer>
+
+class QSocketNotifier;
+
+// Wall clock for displays that show hours and minutes. It sleeps until the next
+// minute boundary instead of polling, and the date is only looked at again once
+// midnight has passed. On Linux the wakeup is an absolute CLOCK_REALTIME timerfd,
+// so it still fires on time after a suspend, and it is cancelled by the kernel
+// when the wall clock is set, which makes both fields be recomputed at once.
+class MinuteClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MinuteClock(QObject *parent = nullptr);
+    ~MinuteClock();
+
+    // Emit the current time and date, then keep following the wall clock
+    void start();
+
+    // No more wakeups until start() is called again, counters are kept
+    void stop();
+
+    // Timer wakeups since start, and the rate over the time running
+    quint64 wakeups() const;
+    qreal wakeupsPerHour() const;
+
+    // Lines for the debug overlay
+    QStringList summaryLines() const;
+
+signals:
+    void minuteChanged(const QTime &time);
+    void dateChanged(const QDate &date);
+
+private slots:
+    void wake();
+
+private:
+    // Recompute what may have changed, the date only past midnight or after a jump
+    void update(bool clockJumped);
+    void schedule();
+
+    int timerFd;
+    QSocketNotifier *notifier;
+    QTimer fallbackTimer;
+
+    QTime currentMinute;
+    QDate currentDate;
+    qint64 nextMidnight;
+
+    QElapsedTimer running;
+    quint64 wakeupCount;
+    int clockJumps;
+};
+
+#endif // MINUTECLOCK_H
@@ -1,22 +1,33 @@
 #include "NetworkControls.h"
 #include "ToggleButton.h"
+#include "ProbeEngine.h"
+#include "NetworkManagerWatcher.h"
+#include "SystemBus.h"
+#include "DetailView.h"
+#include "ProbeScheduler.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
 #include <QStringList>
-#include <QProcess>
 #include <QDebug>
 #include <QRegularExpression>
 
 NetworkControls::NetworkControls(QWidget *parent)
     : QWidget(parent),
     optionPanelLayout(new QVBoxLayout(this)),
-    wifiCheckTimer(new QTimer(this)),
     lastKnownWifiState(false),
-    displayUpdateTimer(new QTimer(this))
+    requestedWifiState(false),
+    probes(new ProbeEngine(this)),
+    wifiReader(std::make_shared<WifiReader>()),
+    networkManager(new NetworkManagerWatcher(SystemBus::connection(), this)),
+    active(false),
+    wifiProbe(0)
 {
+    TRACE_SCOPE("NetworkControls::NetworkControls");
+
     setLayout(optionPanelLayout);
     optionPanelLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
 
     QLabel *titleLabel = new QLabel("Network", this);
-    titleLabel->setStyleSheet("background-color: transparent; color: white;");
     QFont titleFont = titleLabel->font();
     titleFont.setPointSize(30);
     titleFont.setFamily("Arial");
@@ -30,49 +41,134 @@ NetworkControls::NetworkControls(QWidget *parent)
     optionPanelLayout->addSpacing(40);
     optionPanelLayout->addWidget(wifiToggle);
     optionPanelLayout->addSpacing(60);
-    displayNetworkDetails();
     optionPanelLayout->setContentsMargins(25, 25, 0, 0);
 
+    // Detail labels are kept for the lifetime of the panel and only updated in place
+    detailView = new DetailView(this);
+    detailView->setLineWidth(350);
+    optionPanelLayout->addWidget(detailView);
+
+    // Radio state and link are read together once a second while the panel is open,
+    // but only while NetworkManager is not there to push its changes
+    std::shared_ptr<WifiReader> reader = wifiReader;
+    ProbeScheduler::Probe probe;
+    probe.name = "wifi";
+    probe.periodMs = 1000;
+    probe.toleranceMs = 250;
+    probe.context = this;
+    probe.onlyWhileVisible = true;
+    probe.work = [reader]() {
+        return QVariant::fromValue(reader->sample());
+    };
+    probe.deliver = [this](const QVariant &result) {
+        applyWifiSample(result.value<WifiReader::Sample>());
+    };
+    wifiProbe = ProbeScheduler::instance()->add(probe, false);
+
+    // Follow NetworkManager's signals whenever it is on the bus, polling covers the rest
+    connect(networkManager, &NetworkManagerWatcher::watchingChanged, this, [this](bool watching) {
+        ProbeScheduler::instance()->setEnabled(wifiProbe, active && !watching);
+        if (active) {
+            checkWifiState();
+            updateNetworkDisplay();
+        }
+    });
+    connect(networkManager, &NetworkManagerWatcher::wirelessEnabledChanged, this, &NetworkControls::applyWifiState);
+    connect(networkManager, &NetworkManagerWatcher::linkChanged, this, [this]() {
+        if (active && lastKnownWifiState && networkManager->isWatching()) {
+            displayNetworkDetails();
+        }
+    });
+    networkManager->start();
+    displayNetworkDetails();
+
     connect(wifiToggle, &ToggleButton::toggled, this, &NetworkControls::handleWifiToggle);
-    connect(wifiCheckTimer, &QTimer::timeout, this, &NetworkControls::checkWifiState);
-    connect(displayUpdateTimer, &QTimer::timeout, this, &NetworkControls::updateNetworkDisplay);
+    connect(probes, &ProbeEngine::probeFinished, this, &NetworkControls::handleProbeFinished);
+    connect(probes, &ProbeEngine::probeFailed, this, &NetworkControls::handleProbeFailed);
 }
 
 void NetworkControls::setActive(bool active)
 {
+    StallWatchdog::Scope stallScope("NetworkControls::setActive");
+    TRACE_SCOPE("NetworkControls::setActive");
+
+    this->active = active;
+
     if (active)
     {
-        wifiCheckTimer->start(1000);
-        displayUpdateTimer->start(1000);
+        // Nothing needs polling while NetworkManager pushes its changes
+        if (!networkManager->isWatching())
+        {
+            ProbeScheduler::instance()->setEnabled(wifiProbe, true);
+        }
         checkWifiState();
         updateNetworkDisplay();
     }
     else
     {
-        wifiCheckTimer->stop();
-        displayUpdateTimer->stop();
+        ProbeScheduler::instance()->setEnabled(wifiProbe, false);
+
+        // Results of probes still in flight are no longer wanted
+        probes->cancel("radio");
+        probes->cancel("details");
+
+        // Only worth printing when the run is being profiled anyway
+        if (Trace::isEnabled())
+        {
+            const DetailView::Stats &stats = detailView->stats();
+            qDebug() << "Network details:" << stats.updates << "updates," << stats.unchangedUpdates << "unchanged,"
+                     << stats.labelsReused << "label allocations avoided," << stats.textChanges << "text changes";
+        }
     }
 }
 
 void NetworkControls::displayNetworkDetails()
 {
-    static const QRegularExpression spaceSplitter("\\s{2,}");
+    StallWatchdog::Scope stallScope("NetworkControls::displayNetworkDetails");
+    TRACE_SCOPE("NetworkControls::displayNetworkDetails");
 
-    QProcess process;
-    process.start("nmcli", QStringList() << "-f" << "ACTIVE,SSID,BSSID,MODE,CHAN,RATE,SIGNAL,DEVICE" << "device" << "wifi");
-    process.waitForFinished();
+    if (networkManager->isWatching()) {
+        showNetworkDetails(formatLinkDetails(networkManager->link()));
+        return;
+    }
 
-    QString output = process.readAllStandardOutput();
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    // The scheduled probe reads the link from the kernel together with the radio state
+    ProbeScheduler::instance()->trigger(wifiProbe);
+}
 
-    // Clear existing network details
-    QLayoutItem *child;
-    while ((child = optionPanelLayout->takeAt(4)) != nullptr) {
-        delete child->widget();
-        delete child;
+void NetworkControls::applyWifiSample(const WifiReader::Sample &sample)
+{
+    StallWatchdog::Scope stallScope("NetworkControls::applyWifiSample");
+    TRACE_SCOPE("NetworkControls::applyWifiSample");
+
+    if (sample.radio == WifiReader::RadioState::Unknown) {
+        // No rfkill switch to read, ask NetworkManager instead
+        probes->run("radio", "nmcli", QStringList() << "-t" << "-f" << "WIFI" << "radio", 2000);
+    } else if (!probes->isRunning("toggle")) {
+        applyWifiState(sample.radio == WifiReader::RadioState::Enabled);
+    }
+
+    if (!lastKnownWifiState) {
+        probes->cancel("details");
+        showMessage("Wi-Fi is turned off");
+    } else if (sample.linkRead) {
+        showNetworkDetails(formatLinkDetails(sample.link));
+    } else {
+        requestNmcliDetails();
     }
+}
+
+void NetworkControls::requestNmcliDetails()
+{
+    // Fall back to nmcli, results arrive in handleProbeFinished
+    probes->run("details", "nmcli", QStringList() << "-f" << "ACTIVE,SSID,BSSID,MODE,CHAN,RATE,SIGNAL,DEVICE" << "device" << "wifi");
+}
 
-    bool activeConnectionFound = false;
+QStringList NetworkControls::parseNmcliDetails(const QString &output)
+{
+    static const QRegularExpression spaceSplitter("\\s{2,}");
+
+    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
 
     // Skip the header line and find the active connection
     for (int i = 1; i < lines.size(); ++i)
@@ -81,7 +177,7 @@ void NetworkControls::displayNetworkDetails()
         QStringList fields = line.split(spaceSplitter, Qt::SkipEmptyParts);
 
         if (fields.size() >= 8 && fields[0] == "yes") {
-            QStringList formattedDetails = {
+            return {
                 "SSID: " + fields[1],
                 "BSSID: " + fields[2],
                 "Mode: " + fields[3],
@@ -91,105 +187,148 @@ void NetworkControls::displayNetworkDetails()
                 "Device: " + fields[7],
                 ""
             };
-
-            for (const QString &formattedDetail : formattedDetails)
-            {
-                QLabel *label = new QLabel(formattedDetail, this);
-                label->setStyleSheet("background-color: transparent; color: white;");
-                QFont font = label->font();
-                font.setPointSize(16);
-                font.setFamily("Arial");
-                label->setFont(font);
-                label->setWordWrap(true);
-                label->setFixedWidth(350);
-                optionPanelLayout->addWidget(label);
-            }
-            activeConnectionFound = true;
-            break; // Exit after displaying the active connection
         }
     }
+    return QStringList();
+}
 
-    if (!activeConnectionFound) {
-        QLabel *noConnectionLabel = new QLabel("No active Wi-Fi connection", this);
-        noConnectionLabel->setStyleSheet("background-color: transparent; color: white;");
-        QFont font = noConnectionLabel->font();
-        font.setPointSize(16);
-        font.setFamily("Arial");
-        noConnectionLabel->setFont(font);
-        optionPanelLayout->addWidget(noConnectionLabel);
+QStringList NetworkControls::formatLinkDetails(const WifiReader::LinkDetails &link)
+{
+    if (!link.connected) {
+        return QStringList();
     }
+
+    // Same fields and units as the nmcli output
+    return {
+        "SSID: " + link.ssid,
+        "BSSID: " + link.bssid,
+        "Mode: " + link.mode,
+        "Channel: " + QString::number(link.channel),
+        "Rate: " + QString::number(link.rateMbps) + " Mbit/s",
+        "Signal: " + QString::number(link.signal),
+        "Device: " + link.device,
+        ""
+    };
 }
 
-void NetworkControls::updateNetworkDisplay()
+void NetworkControls::showNetworkDetails(const QStringList &formattedDetails)
 {
-    qDebug() << "Display update timer triggered";
-
-    // Clear existing network details
-    QLayoutItem *child;
-    while ((child = optionPanelLayout->takeAt(4)) != nullptr) {
-        delete child->widget();
-        delete child;
+    if (formattedDetails.isEmpty()) {
+        showMessage("No active Wi-Fi connection");
+        return;
     }
+    detailView->setLines(formattedDetails);
+}
+
+void NetworkControls::showMessage(const QString &text)
+{
+    detailView->setLines(QStringList() << text);
+}
 
+void NetworkControls::updateNetworkDisplay()
+{
     if (lastKnownWifiState) {
+        // Keep the current labels until fresh details arrive
         displayNetworkDetails();
     } else {
-        QLabel *noConnectionLabel = new QLabel("Wi-Fi is turned off", this);
-        noConnectionLabel->setStyleSheet("background-color: transparent; color: white;");
-        QFont font = noConnectionLabel->font();
-        font.setPointSize(16);
-        font.setFamily("Arial");
-        noConnectionLabel->setFont(font);
-        optionPanelLayout->addWidget(noConnectionLabel);
+        probes->cancel("details");
+        showMessage("Wi-Fi is turned off");
     }
-
-    qDebug() << "Display update completed";
 }
 
 void NetworkControls::checkWifiState()
 {
-    qDebug() << "WiFi check timer triggered";
-
-    QProcess process;
-    process.start("nmcli", QStringList() << "-t" << "-f" << "WIFI" << "radio");
-    process.waitForFinished();
-    bool isEnabled = (process.readAllStandardOutput().trimmed() == "enabled");
+    StallWatchdog::Scope stallScope("NetworkControls::checkWifiState");
+    TRACE_SCOPE("NetworkControls::checkWifiState");
 
-    if (isEnabled != lastKnownWifiState) {
-        lastKnownWifiState = isEnabled;
-        wifiToggle->setToggleState(isEnabled);
-        // updateNetworkDisplay();
+    if (networkManager->isWatching()) {
+        applyWifiState(networkManager->wirelessEnabled());
+        return;
     }
 
-    qDebug() << "WiFi check completed";
+    // Results arrive in applyWifiSample
+    ProbeScheduler::instance()->trigger(wifiProbe);
+}
+
+void NetworkControls::applyWifiState(bool enabled)
+{
+    if (enabled != lastKnownWifiState) {
+        lastKnownWifiState = enabled;
+        wifiToggle->setToggleState(enabled);
+
+        // Show the new state straight away instead of on the next display tick
+        if (active) {
+            updateNetworkDisplay();
+        }
+    }
 }
 
 void NetworkControls::handleWifiToggle(bool enabled)
 {
+    StallWatchdog::Scope stallScope("NetworkControls::handleWifiToggle");
+    TRACE_SCOPE("NetworkControls::handleWifiToggle");
+
     if (enabled == lastKnownWifiState) {
         return;
     }
 
-    QProcess process;
-    process.start("nmcli", QStringList() << "radio" << "wifi" << (enabled ? "on" : "off"));
-    process.waitForFinished();
+    if (probes->isRunning("toggle")) {
+        // Keep showing the state that is still being applied
+        wifiToggle->setToggleState(requestedWifiState);
+        return;
+    }
+
+    // A state check racing the toggle would report the old state
+    probes->cancel("radio");
+
+    requestedWifiState = enabled;
+    probes->run("toggle", "nmcli", QStringList() << "radio" << "wifi" << (enabled ? "on" : "off"), 10000);
+}
 
-    if (process.exitCode() == 0) {
+void NetworkControls::applyWifiToggleResult(bool succeeded, const QString &error)
+{
+    bool enabled = requestedWifiState;
+
+    if (succeeded) {
         lastKnownWifiState = enabled;
 
         if (enabled) {
             // Re-activate timers and update display when Wi-Fi is enabled
             setActive(true);
         } else {
-            // Stop timers when Wi-Fi is disabled
-            wifiCheckTimer->stop();
-            displayUpdateTimer->stop();
+            // Stop polling when Wi-Fi is disabled
+            ProbeScheduler::instance()->setEnabled(wifiProbe, false);
             updateNetworkDisplay(); // Update display to show Wi-Fi is off
         }
 
         qDebug() << "Wi-Fi successfully" << (enabled ? "enabled" : "disabled");
     } else {
-        qDebug() << "Failed to change Wi-Fi state:" << process.readAllStandardError();
+        qDebug() << "Failed to change Wi-Fi state:" << error;
         wifiToggle->setToggleState(!enabled);  // Revert the toggle state
     }
 }
+
+void NetworkControls::handleProbeFinished(const QString &key, int exitCode, const QByteArray &output)
+{
+    StallWatchdog::Scope stallScope("NetworkControls::handleProbeFinished");
+    TRACE_SCOPE("NetworkControls::handleProbeFinished");
+
+    if (key == "radio") {
+        if (!probes->isRunning("toggle")) {
+            applyWifiState(output.trimmed() == "enabled");
+        }
+    } else if (key == "details") {
+        showNetworkDetails(parseNmcliDetails(QString::fromUtf8(output)));
+    } else if (key == "toggle") {
+        applyWifiToggleResult(exitCode == 0, QString("nmcli exited with code %1").arg(exitCode));
+    }
+}
+
+void NetworkControls::handleProbeFailed(const QString &key, const QString &reason)
+{
+    qDebug() << "Network probe" << key << "failed:" << reason;
+
+    if (key == "toggle") {
+        applyWifiToggleResult(false, reason);
+    }
+}
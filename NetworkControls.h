@@ -4,9 +4,14 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QLabel>
-#include <QTimer>
+#include <memory>
+
+#include "WifiReader.h"
 
 class ToggleButton;
+class ProbeEngine;
+class NetworkManagerWatcher;
+class DetailView;
 
 class NetworkControls : public QWidget
 {
@@ -16,24 +21,42 @@ public:
     explicit NetworkControls(QWidget *parent = nullptr);
     bool checkDependencies();
 
+    // Turn nmcli or native link details into the lines shown in the panel
+    static QStringList parseNmcliDetails(const QString &output);
+    static QStringList formatLinkDetails(const WifiReader::LinkDetails &link);
+
     void setActive(bool active);
 
 private slots:
     void checkWifiState();
     void handleWifiToggle(bool enabled);
 
+    // Probe result handlers
+    void handleProbeFinished(const QString &key, int exitCode, const QByteArray &output);
+    void handleProbeFailed(const QString &key, const QString &reason);
+
 private:
     void displayNetworkDetails();
     void updateNetworkDisplay();
+    void showNetworkDetails(const QStringList &formattedDetails);
+    void showMessage(const QString &text);
+    void applyWifiSample(const WifiReader::Sample &sample);
+    void requestNmcliDetails();
+    void applyWifiState(bool enabled);
+    void applyWifiToggleResult(bool succeeded, const QString &error);
     QStringList getWifiDetails();
 
     QVBoxLayout *optionPanelLayout;
     ToggleButton *wifiToggle;
-    QTimer *wifiCheckTimer;
+    DetailView *detailView;
     bool lastKnownWifiState;
+    bool requestedWifiState;
 
-    QTimer *displayUpdateTimer;
-    QTimer *enableWifiTimer;
+    ProbeEngine *probes;
+    std::shared_ptr<WifiReader> wifiReader; // Shared with probe runs on the worker pool
+    NetworkManagerWatcher *networkManager;
+    bool active;
+    int wifiProbe;
 };
 
 #endif // NETWORKCONTROLS_H
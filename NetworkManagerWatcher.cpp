@@ -0,0 +1,368 @@
+#include "NetworkManagerWatcher.h"
+
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QDebug>
+
+namespace {
+
+const QString Service = "org.freedesktop.NetworkManager";
+const QString ManagerPath = "/org/freedesktop/NetworkManager";
+const QString ManagerInterface = "org.freedesktop.NetworkManager";
+const QString DeviceInterface = "org.freedesktop.NetworkManager.Device";
+const QString WirelessInterface = "org.freedesktop.NetworkManager.Device.Wireless";
+const QString AccessPointInterface = "org.freedesktop.NetworkManager.AccessPoint";
+const QString PropertiesInterface = "org.freedesktop.DBus.Properties";
+
+// NM_DEVICE_TYPE_WIFI
+const uint DeviceTypeWifi = 2;
+
+QString accessPointMode(uint mode)
+{
+    // NM_802_11_MODE values
+    switch (mode)
+    {
+    case 1: return "Ad-Hoc";
+    case 2: return "Infra";
+    case 3: return "AP";
+    case 4: return "Mesh";
+    default: return "Unknown";
+    }
+}
+
+bool sameLink(const WifiReader::LinkDetails &a, const WifiReader::LinkDetails &b)
+{
+    return a.connected == b.connected && a.device == b.device && a.ssid == b.ssid &&
+           a.bssid == b.bssid && a.mode == b.mode && a.channel == b.channel &&
+           a.rateMbps == b.rateMbps && a.signal == b.signal;
+}
+
+} // namespace
+
+NetworkManagerWatcher::NetworkManagerWatcher(const QDBusConnection &bus, QObject *parent)
+    : QObject(parent),
+    bus(bus),
+    serviceWatcher(nullptr),
+    generation(0),
+    watching(false),
+    enabled(false)
+{
+}
+
+bool NetworkManagerWatcher::start()
+{
+    if (serviceWatcher)
+    {
+        return true;
+    }
+    if (!bus.isConnected())
+    {
+        qDebug() << "No D-Bus connection, falling back to polling";
+        return false;
+    }
+
+    // NameOwnerChanged reports NetworkManager starting, stopping and restarting
+    serviceWatcher = new QDBusServiceWatcher(Service, bus, QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged,
+            this, &NetworkManagerWatcher::serviceOwnerChanged);
+
+    // The current owner is asked for asynchronously, the GUI thread never waits on the bus
+    QDBusMessage call = QDBusMessage::createMethodCall("org.freedesktop.DBus", "/org/freedesktop/DBus",
+                                                       "org.freedesktop.DBus", "GetNameOwner");
+    call << Service;
+    QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(bus.asyncCall(call), this);
+    connect(callWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *finishedCall) {
+        QDBusPendingReply<QString> reply = *finishedCall;
+        finishedCall->deleteLater();
+
+        if (reply.isError())
+        {
+            qDebug() << "NetworkManager is not on the bus, polling until it appears";
+            return;
+        }
+        // An owner change may have been seen first
+        if (owner.isEmpty())
+        {
+            serviceOwnerChanged(Service, QString(), reply.value());
+        }
+    });
+    return true;
+}
+
+bool NetworkManagerWatcher::isWatching() const
+{
+    return watching;
+}
+
+bool NetworkManagerWatcher::wirelessEnabled() const
+{
+    return enabled;
+}
+
+WifiReader::LinkDetails NetworkManagerWatcher::link() const
+{
+    return current;
+}
+
+void NetworkManagerWatcher::serviceOwnerChanged(const QString &, const QString &, const QString &newOwner)
+{
+    if (newOwner == owner)
+    {
+        return;
+    }
+
+    const bool wasWatching = watching;
+    reset();
+    owner = newOwner;
+    watching = !owner.isEmpty();
+
+    if (watching)
+    {
+        qDebug() << "NetworkManager is on the bus, following its signals";
+
+        // Subscribe before reading so no change can slip in between
+        watch(ManagerPath);
+        getAll(ManagerPath, ManagerInterface, [this](const QVariantMap &properties) {
+            applyManagerProperties(properties);
+            findWifiDevice(properties);
+        });
+    }
+    else
+    {
+        qDebug() << "NetworkManager left the bus, falling back to polling";
+    }
+
+    // A restart is reported as watching again, the receiver re-reads the state
+    if (watching || wasWatching)
+    {
+        emit watchingChanged(watching);
+    }
+}
+
+void NetworkManagerWatcher::reset()
+{
+    ++generation;
+
+    if (watching)
+    {
+        unwatch(ManagerPath);
+    }
+    if (!devicePath.isEmpty())
+    {
+        unwatch(devicePath);
+        devicePath.clear();
+    }
+    if (!accessPointPath.isEmpty())
+    {
+        unwatch(accessPointPath);
+        accessPointPath.clear();
+    }
+    watching = false;
+    updateLink(WifiReader::LinkDetails());
+}
+
+void NetworkManagerWatcher::getAll(const QString &path, const QString &interface, std::function<void(const QVariantMap &)> handler)
+{
+    QDBusMessage call = QDBusMessage::createMethodCall(Service, path, PropertiesInterface, "GetAll");
+    call << interface;
+
+    const int callGeneration = generation;
+    QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(bus.asyncCall(call), this);
+    connect(callWatcher, &QDBusPendingCallWatcher::finished, this, [this, handler, path, interface, callGeneration](QDBusPendingCallWatcher *finishedCall) {
+        QDBusPendingReply<QVariantMap> reply = *finishedCall;
+        finishedCall->deleteLater();
+
+        // Sent to a NetworkManager that has gone since
+        if (callGeneration != generation)
+        {
+            return;
+        }
+        if (reply.isError())
+        {
+            qDebug() << "Failed to read" << interface << "properties of" << path << ":" << reply.error().message();
+            return;
+        }
+        handler(reply.value());
+    });
+}
+
+void NetworkManagerWatcher::watch(const QString &path)
+{
+    bus.connect(Service, path, PropertiesInterface, "PropertiesChanged",
+                this, SLOT(propertiesChanged(QDBusMessage)));
+}
+
+void NetworkManagerWatcher::unwatch(const QString &path)
+{
+    bus.disconnect(Service, path, PropertiesInterface, "PropertiesChanged",
+                   this, SLOT(propertiesChanged(QDBusMessage)));
+}
+
+void NetworkManagerWatcher::propertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() < 2)
+    {
+        return;
+    }
+
+    const QString interface = arguments.at(0).toString();
+    const QVariantMap changed = qdbus_cast<QVariantMap>(arguments.at(1));
+    const QString path = message.path();
+
+    if (path == ManagerPath && interface == ManagerInterface)
+    {
+        applyManagerProperties(changed);
+
+        // A Wi-Fi adapter may be plugged in after startup
+        if (devicePath.isEmpty() && changed.contains("Devices"))
+        {
+            findWifiDevice(changed);
+        }
+    }
+    else if (path == devicePath && interface == WirelessInterface)
+    {
+        applyWirelessProperties(changed);
+    }
+    else if (path == accessPointPath && interface == AccessPointInterface)
+    {
+        applyAccessPointProperties(changed);
+    }
+}
+
+void NetworkManagerWatcher::findWifiDevice(const QVariantMap &managerProperties)
+{
+    const QList<QDBusObjectPath> devices = qdbus_cast<QList<QDBusObjectPath>>(managerProperties.value("Devices"));
+    for (const QDBusObjectPath &device : devices)
+    {
+        const QString path = device.path();
+        getAll(path, DeviceInterface, [this, path](const QVariantMap &properties) {
+            // Only the first Wi-Fi device is shown in the panel
+            if (!devicePath.isEmpty() || properties.value("DeviceType").toUInt() != DeviceTypeWifi)
+            {
+                return;
+            }
+            devicePath = path;
+
+            WifiReader::LinkDetails details = current;
+            details.device = properties.value("Interface").toString();
+            updateLink(details);
+
+            watch(path);
+            getAll(path, WirelessInterface, [this](const QVariantMap &wirelessProperties) {
+                applyWirelessProperties(wirelessProperties);
+            });
+        });
+    }
+}
+
+void NetworkManagerWatcher::applyManagerProperties(const QVariantMap &properties)
+{
+    auto it = properties.constFind("WirelessEnabled");
+    if (it == properties.constEnd())
+    {
+        return;
+    }
+
+    bool wirelessEnabled = it->toBool();
+    if (wirelessEnabled != enabled)
+    {
+        enabled = wirelessEnabled;
+        emit wirelessEnabledChanged(enabled);
+    }
+}
+
+void NetworkManagerWatcher::applyWirelessProperties(const QVariantMap &properties)
+{
+    auto it = properties.constFind("Bitrate");
+    if (it != properties.constEnd())
+    {
+        // Reported in kbit/s
+        WifiReader::LinkDetails details = current;
+        details.rateMbps = int(it->toUInt() / 1000);
+        updateLink(details);
+    }
+
+    it = properties.constFind("ActiveAccessPoint");
+    if (it != properties.constEnd())
+    {
+        setAccessPoint(qdbus_cast<QDBusObjectPath>(*it).path());
+    }
+}
+
+void NetworkManagerWatcher::applyAccessPointProperties(const QVariantMap &properties)
+{
+    WifiReader::LinkDetails details = current;
+    details.connected = true;
+
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it)
+    {
+        if (it.key() == "Ssid")
+        {
+            details.ssid = QString::fromUtf8(it->toByteArray());
+        }
+        else if (it.key() == "HwAddress")
+        {
+            details.bssid = it->toString();
+        }
+        else if (it.key() == "Frequency")
+        {
+            details.channel = WifiReader::frequencyToChannel(int(it->toUInt()));
+        }
+        else if (it.key() == "Strength")
+        {
+            details.signal = it->toInt();
+        }
+        else if (it.key() == "Mode")
+        {
+            details.mode = accessPointMode(it->toUInt());
+        }
+    }
+    updateLink(details);
+}
+
+void NetworkManagerWatcher::setAccessPoint(const QString &path)
+{
+    // NetworkManager uses "/" for "no access point"
+    QString newPath = (path == "/") ? QString() : path;
+    if (newPath == accessPointPath)
+    {
+        return;
+    }
+
+    if (!accessPointPath.isEmpty())
+    {
+        unwatch(accessPointPath);
+    }
+    accessPointPath = newPath;
+
+    if (accessPointPath.isEmpty())
+    {
+        WifiReader::LinkDetails details;
+        details.device = current.device;
+        updateLink(details);
+        return;
+    }
+
+    watch(accessPointPath);
+    getAll(accessPointPath, AccessPointInterface, [this, newPath](const QVariantMap &properties) {
+        // Ignore replies for an access point we have already left
+        if (newPath == accessPointPath)
+        {
+            applyAccessPointProperties(properties);
+        }
+    });
+}
+
+void NetworkManagerWatcher::updateLink(const WifiReader::LinkDetails &details)
+{
+    if (sameLink(details, current))
+    {
+        return;
+    }
+    current = details;
+    emit linkChanged();
+}
@@ -0,0 +1,68 @@
+#ifndef NETWORKMANAGERWATCHER_H
+#define NETWORKMANAGERWATCHER_H
+
+#include "WifiReader.h"
+
+#include <QObject>
+#include <QDBusConnection>
+#include <QVariantMap>
+#include <functional>
+
+class QDBusMessage;
+class QDBusServiceWatcher;
+
+// Tracks the Wi-Fi radio and the active access point through NetworkManager's
+// PropertiesChanged signals, so nothing has to be polled while the link is idle.
+// NetworkManager's bus name is followed as well: when it goes away watching
+// stops, and when it comes back (or restarts) everything is read again.
+class NetworkManagerWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkManagerWatcher(const QDBusConnection &bus, QObject *parent = nullptr);
+
+    // Returns false when there is no bus. Whether NetworkManager is on it is asked
+    // without blocking, watchingChanged() reports the answer and every later change.
+    bool start();
+    bool isWatching() const;
+
+    bool wirelessEnabled() const;
+    WifiReader::LinkDetails link() const;
+
+signals:
+    void watchingChanged(bool watching);
+    void wirelessEnabledChanged(bool enabled);
+    void linkChanged();
+
+private slots:
+    void propertiesChanged(const QDBusMessage &message);
+    void serviceOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner);
+
+private:
+    // Drop everything read from the previous owner
+    void reset();
+
+    void getAll(const QString &path, const QString &interface, std::function<void(const QVariantMap &)> handler);
+    void watch(const QString &path);
+    void unwatch(const QString &path);
+
+    void findWifiDevice(const QVariantMap &managerProperties);
+    void applyManagerProperties(const QVariantMap &properties);
+    void applyWirelessProperties(const QVariantMap &properties);
+    void applyAccessPointProperties(const QVariantMap &properties);
+    void setAccessPoint(const QString &path);
+    void updateLink(const WifiReader::LinkDetails &details);
+
+    QDBusConnection bus;
+    QDBusServiceWatcher *serviceWatcher;
+    QString owner;   // unique name of the running NetworkManager, empty when it is gone
+    int generation;  // bumped on every owner change, replies from an older one are dropped
+    bool watching;
+    bool enabled;
+    QString devicePath;
+    QString accessPointPath;
+    WifiReader::LinkDetails current;
+};
+
+#endif // NETWORKMANAGERWATCHER_H
@@ -0,0 +1,56 @@
+#include "PanelSnapshot.h"
+#include "Trace.h"
+
+#include <QLayout>
+#include <QPainter>
+
+PanelSnapshot::PanelSnapshot(QWidget *parent)
+    : QWidget(parent)
+{
+    // Every pixel is painted from the pixmap or left to the parent, nothing to clear
+    setAttribute(Qt::WA_NoSystemBackground);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    hide();
+}
+
+void PanelSnapshot::capture(QWidget *panel, const QPoint &position)
+{
+    TRACE_SCOPE("PanelSnapshot::capture");
+
+    // A panel that has not been shown yet still has a pending layout
+    if (panel->layout())
+    {
+        panel->layout()->activate();
+    }
+    pixmap = panel->grab();
+
+    stats = FrameStats();
+    frameClock.invalidate();
+
+    setGeometry(QRect(position, panel->size()));
+    show();
+    raise();
+}
+
+PanelSnapshot::FrameStats PanelSnapshot::release()
+{
+    hide();
+    pixmap = QPixmap();
+    return stats;
+}
+
+void PanelSnapshot::paintEvent(QPaintEvent *)
+{
+    if (frameClock.isValid())
+    {
+        const qint64 interval = frameClock.nsecsElapsed();
+        ++stats.frames;
+        stats.totalNs += interval;
+        stats.worstNs = qMax(stats.worstNs, interval);
+    }
+    frameClock.start();
+
+    // The painter is clipped to the exposed region, only that part is blitted
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, pixmap);
+}
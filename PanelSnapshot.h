@@ -0,0 +1,41 @@
+#ifndef PANELSNAPSHOT_H
+#define PANELSNAPSHOT_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QElapsedTimer>
+
+// Stands in for a panel while it moves. The panel is rendered into a pixmap
+// once, then only this childless widget is moved and its pixmap blitted, so a
+// frame costs no layout and no repaint of the live widgets underneath. Frame
+// intervals are recorded while it is shown.
+class PanelSnapshot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    struct FrameStats
+    {
+        int frames = 0;
+        qint64 totalNs = 0;  // sum of the intervals between frames
+        qint64 worstNs = 0;
+    };
+
+    explicit PanelSnapshot(QWidget *parent = nullptr);
+
+    // Render the panel as it is laid out now and show the picture in its place at the given position
+    void capture(QWidget *panel, const QPoint &position);
+
+    // Hide and drop the pixmap, returns the frame timing of the motion
+    FrameStats release();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QPixmap pixmap;
+    QElapsedTimer frameClock;
+    FrameStats stats;
+};
+
+#endif // PANELSNAPSHOT_H
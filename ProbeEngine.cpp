@@ -0,0 +1,144 @@
+#include "ProbeEngine.h"
+#include "CommandStats.h"
+
+#include <QProcess>
+#include <QTimer>
+#include <QDebug>
+
+ProbeEngine::ProbeEngine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+// Destructor
+ProbeEngine::~ProbeEngine()
+{
+    cancelAll();
+
+    // Killed processes exit at once, reap them before they are deleted with us
+    const QList<QProcess *> processes = findChildren<QProcess *>(Qt::FindDirectChildrenOnly);
+    for (QProcess *process : processes)
+    {
+        if (process->state() != QProcess::NotRunning)
+        {
+            process->waitForFinished(1000);
+        }
+    }
+}
+
+bool ProbeEngine::run(const QString &key, const QString &program, const QStringList &arguments, int timeoutMs)
+{
+    // Never run the same probe twice at once
+    if (probes.contains(key))
+    {
+        return false;
+    }
+
+    QProcess *process = new QProcess(this);
+    QTimer *timeoutTimer = new QTimer(process);
+    timeoutTimer->setSingleShot(true);
+
+    connect(process, &QProcess::finished, this, [this, key, process](int exitCode, QProcess::ExitStatus exitStatus) {
+        QByteArray output = process->readAllStandardOutput();
+        recordRun(key, exitStatus == QProcess::NormalExit ? exitCode : -1, output.size());
+        release(key);
+        process->deleteLater();
+
+        if (exitStatus == QProcess::NormalExit)
+        {
+            emit probeFinished(key, exitCode, output);
+        }
+        else
+        {
+            emit probeFailed(key, "crashed");
+        }
+    });
+
+    connect(process, &QProcess::errorOccurred, this, [this, key, process](QProcess::ProcessError error) {
+        // Crashes and timeouts are handled elsewhere, only a failed start ends the probe here
+        if (error != QProcess::FailedToStart)
+        {
+            return;
+        }
+        QString reason = process->errorString();
+        recordRun(key, -1, 0);
+        release(key);
+        process->deleteLater();
+        emit probeFailed(key, reason);
+    });
+
+    connect(timeoutTimer, &QTimer::timeout, this, [this, key]() {
+        qDebug() << "Probe" << key << "timed out";
+        recordRun(key, -1, 0);
+        discard(key);
+        emit probeFailed(key, "timed out");
+    });
+
+    Probe probe{process, timeoutTimer, CommandStats::commandKey(program, arguments)};
+    probe.started.start();
+    probes.insert(key, probe);
+    timeoutTimer->start(timeoutMs);
+    process->start(program, arguments);
+    return true;
+}
+
+bool ProbeEngine::isRunning(const QString &key) const
+{
+    return probes.contains(key);
+}
+
+void ProbeEngine::cancel(const QString &key)
+{
+    discard(key);
+}
+
+void ProbeEngine::cancelAll()
+{
+    const QStringList keys = probes.keys();
+    for (const QString &key : keys)
+    {
+        discard(key);
+    }
+}
+
+void ProbeEngine::discard(const QString &key)
+{
+    QProcess *process = release(key);
+    if (!process)
+    {
+        return;
+    }
+    if (process->state() == QProcess::NotRunning)
+    {
+        process->deleteLater();
+        return;
+    }
+
+    // Deleted once the kill has been reaped, deleting a running process leaves a zombie behind
+    connect(process, &QProcess::finished, process, &QObject::deleteLater);
+    process->kill();
+}
+
+void ProbeEngine::recordRun(const QString &key, int exitCode, qint64 outputBytes)
+{
+    auto it = probes.constFind(key);
+    if (it != probes.constEnd())
+    {
+        CommandStats::instance()->record(it->command, it->started.nsecsElapsed() / 1000, exitCode, outputBytes);
+    }
+}
+
+QProcess *ProbeEngine::release(const QString &key)
+{
+    Probe probe = probes.take(key);
+    if (!probe.process)
+    {
+        return nullptr;
+    }
+
+    // Drop the connections first so nothing else is reported for this probe
+    probe.timeoutTimer->stop();
+    probe.timeoutTimer->disconnect(this);
+    probe.process->disconnect(this);
+    return probe.process;
+}
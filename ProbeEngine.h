@@ -0,0 +1,59 @@
+#ifndef PROBEENGINE_H
+#define PROBEENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+class QProcess;
+class QTimer;
+
+// Runs external commands asynchronously so the GUI thread never blocks on them.
+// Each probe is identified by a key; a key that is still in flight is not started
+// a second time, and cancelled probes never report back.
+class ProbeEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeEngine(QObject *parent = nullptr);
+    ~ProbeEngine();
+
+    // Start a probe, returns false if a probe with the same key is already running
+    bool run(const QString &key, const QString &program, const QStringList &arguments, int timeoutMs = 3000);
+
+    bool isRunning(const QString &key) const;
+
+    // Kill running probes without emitting any result
+    void cancel(const QString &key);
+    void cancelAll();
+
+signals:
+    // Emitted when a probe exits normally
+    void probeFinished(const QString &key, int exitCode, const QByteArray &output);
+
+    // Emitted when a probe fails to start, crashes or times out
+    void probeFailed(const QString &key, const QString &reason);
+
+private:
+    struct Probe
+    {
+        QProcess *process = nullptr;
+        QTimer *timeoutTimer = nullptr;
+        QString command;
+        QElapsedTimer started;
+    };
+
+    // Kill a probe, its process is deleted once it has exited
+    void discard(const QString &key);
+    void recordRun(const QString &key, int exitCode, qint64 outputBytes);
+    // Forget a probe, the caller deletes the process
+    QProcess *release(const QString &key);
+
+    QHash<QString, Probe> probes;
+};
+
+#endif // PROBEENGINE_H
@@ -0,0 +1,299 @@
+#include "ProbeScheduler.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QWidget>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// Catch-up runs after idle wait this long, the resumed frame is drawn first
+const qint64 ResumeDelayMs = 250;
+
+} // namespace
+
+ProbeScheduler *ProbeScheduler::instance()
+{
+    static ProbeScheduler *scheduler = new ProbeScheduler(qApp);
+    return scheduler;
+}
+
+ProbeScheduler::ProbeScheduler(QObject *parent)
+    : QObject(parent),
+    lastId(0),
+    timer(new QTimer(this)),
+    wakeupCount(0),
+    idle(false)
+{
+    clock.start();
+
+    // Probes are short, a few threads keep a slow one from holding up the rest
+    pool.setMaxThreadCount(3);
+
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &ProbeScheduler::wake);
+}
+
+// Destructor
+ProbeScheduler::~ProbeScheduler()
+{
+    pool.waitForDone();
+}
+
+int ProbeScheduler::add(const Probe &probe, bool enabled)
+{
+    Entry entry;
+    entry.probe = probe;
+    entry.enabled = enabled;
+    entry.deadline = clock.elapsed() + qMax(period(entry), probe.periodMs);
+
+    // Parking and re-arming follow the widget's show and hide events
+    if (probe.onlyWhileVisible && probe.context)
+    {
+        probe.context->installEventFilter(this);
+    }
+
+    int id = ++lastId;
+    entries.insert(id, entry);
+    reschedule();
+    return id;
+}
+
+void ProbeScheduler::remove(int id)
+{
+    // A run still in flight finds its entry gone and drops the result
+    if (entries.remove(id))
+    {
+        reschedule();
+    }
+}
+
+void ProbeScheduler::setEnabled(int id, bool enabled)
+{
+    auto it = entries.find(id);
+    if (it == entries.end() || it->enabled == enabled)
+    {
+        return;
+    }
+    it->enabled = enabled;
+    if (enabled)
+    {
+        it->deadline = clock.elapsed() + qMax(period(*it), it->probe.periodMs);
+    }
+    reschedule();
+}
+
+void ProbeScheduler::trigger(int id)
+{
+    auto it = entries.find(id);
+    if (it == entries.end() || it->running)
+    {
+        return;
+    }
+    it->deadline = clock.elapsed() + qMax(period(*it), it->probe.periodMs);
+    dispatch(id);
+    reschedule();
+}
+
+QThreadPool *ProbeScheduler::workerPool()
+{
+    return &pool;
+}
+
+void ProbeScheduler::setIdle(bool isIdle)
+{
+    if (idle == isIdle)
+    {
+        return;
+    }
+    idle = isIdle;
+
+    // Entering idle, stretched probes take their idle period from their next run on
+    if (!idle)
+    {
+        // Back to the normal period, overdue probes run together just after the resume
+        const qint64 now = clock.elapsed();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            it->deadline = qMin(qMax(it->deadline, now + ResumeDelayMs),
+                                now + qMax<qint64>(it->probe.periodMs, ResumeDelayMs));
+        }
+    }
+    reschedule();
+}
+
+bool ProbeScheduler::isIdle() const
+{
+    return idle;
+}
+
+quint64 ProbeScheduler::wakeups() const
+{
+    return wakeupCount;
+}
+
+void ProbeScheduler::wake()
+{
+    StallWatchdog::Scope stallScope("ProbeScheduler::wake");
+    TRACE_SCOPE("ProbeScheduler::wake");
+
+    ++wakeupCount;
+    const qint64 now = clock.elapsed();
+
+    // Every probe whose deadline has passed shares this wakeup
+    QList<int> due;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        if (it->enabled && period(*it) > 0 && it->deadline <= now)
+        {
+            due.append(it.key());
+        }
+    }
+
+    // Higher priority probes are queued on the pool first
+    std::sort(due.begin(), due.end(), [this](int a, int b) {
+        return entries.value(a).probe.priority > entries.value(b).probe.priority;
+    });
+
+    for (int id : std::as_const(due))
+    {
+        auto it = entries.find(id);
+        if (it == entries.end())
+        {
+            // Removed by an earlier delivery in this wakeup
+            continue;
+        }
+
+        it->deadline = now + period(*it);
+
+        if (!it->probe.context)
+        {
+            entries.erase(it);
+            continue;
+        }
+
+        if (!it->running)
+        {
+            dispatch(id);
+        }
+    }
+
+    reschedule();
+}
+
+void ProbeScheduler::dispatch(int id)
+{
+    auto it = entries.find(id);
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    const Probe &probe = it->probe;
+    if (!probe.work)
+    {
+        // Nothing to do off the GUI thread
+        std::function<void(const QVariant &)> deliver = probe.deliver;
+        if (deliver)
+        {
+            deliver(QVariant());
+        }
+        return;
+    }
+
+    it->running = true;
+
+    QFutureWatcher<QVariant> *watcher = new QFutureWatcher<QVariant>(this);
+    connect(watcher, &QFutureWatcher<QVariant>::finished, this, [this, watcher, id]() {
+        QVariant result = watcher->result();
+        watcher->deleteLater();
+
+        auto it = entries.find(id);
+        if (it == entries.end())
+        {
+            return;
+        }
+        it->running = false;
+
+        if (it->probe.context && it->probe.deliver)
+        {
+            std::function<void(const QVariant &)> deliver = it->probe.deliver;
+            deliver(result);
+        }
+    });
+
+    // The task keeps its own copy, the entry may be removed while it runs
+    std::function<QVariant()> work = probe.work;
+    const int poolPriority = int(probe.priority);
+    watcher->setFuture(QtConcurrent::task(std::move(work))
+                           .onThreadPool(pool)
+                           .withPriority(poolPriority)
+                           .spawn());
+}
+
+void ProbeScheduler::reschedule()
+{
+    // Wake at the earliest point where some probe would otherwise run late
+    qint64 wakeAt = -1;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        if (!it->enabled || period(*it) == 0)
+        {
+            continue;
+        }
+        qint64 latest = it->deadline + it->probe.toleranceMs;
+        if (wakeAt < 0 || latest < wakeAt)
+        {
+            wakeAt = latest;
+        }
+    }
+
+    if (wakeAt < 0)
+    {
+        timer->stop();
+        return;
+    }
+    timer->start(int(qMax<qint64>(0, wakeAt - clock.elapsed())));
+}
+
+int ProbeScheduler::period(const Entry &entry) const
+{
+    // Nobody is looking at a hidden panel, its probe waits for the next show event
+    if (entry.probe.onlyWhileVisible)
+    {
+        QWidget *widget = qobject_cast<QWidget *>(entry.probe.context.data());
+        if (widget && !widget->isVisible())
+        {
+            return 0;
+        }
+    }
+    return idle ? entry.probe.idlePeriodMs : entry.probe.periodMs;
+}
+
+bool ProbeScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::Show && event->type() != QEvent::Hide)
+    {
+        return QObject::eventFilter(watched, event);
+    }
+
+    // Shown again: a full period from now, the panel refreshes itself when it opens
+    if (event->type() == QEvent::Show)
+    {
+        const qint64 now = clock.elapsed();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->probe.onlyWhileVisible && it->probe.context == watched)
+            {
+                it->deadline = now + it->probe.periodMs;
+            }
+        }
+    }
+    reschedule();
+    return QObject::eventFilter(watched, event);
+}
@@ -0,0 +1,111 @@
+#ifndef PROBESCHEDULER_H
+#define PROBESCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include <QVariant>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <functional>
+
+class QTimer;
+
+// Owns every periodic system probe of the panel. Deadlines are coalesced into
+// shared wakeups: a probe may run anywhere between its deadline and deadline +
+// tolerance, so a single timer wakeup serves every probe whose window is open.
+// Probe work runs on a small shared worker pool, results are delivered on the
+// GUI thread.
+class ProbeScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    struct Probe
+    {
+        QString name;
+        int periodMs = 1000;
+        int toleranceMs = 0;
+        Priority priority = Normal;
+
+        // Period while the panel is idle, 0 pauses the probe until it is used again
+        int idlePeriodMs = 0;
+
+        // The probe is removed when the context is destroyed. When onlyWhileVisible is
+        // set the context must be a widget; the probe is parked while it is hidden and
+        // falls due one period after it is shown again.
+        QPointer<QObject> context;
+        bool onlyWhileVisible = false;
+
+        // Runs on the worker pool, may be empty for probes that only touch the GUI
+        std::function<QVariant()> work;
+
+        // Runs on the GUI thread with the result of work
+        std::function<void(const QVariant &)> deliver;
+    };
+
+    // Shared by all panels, owned by the application
+    static ProbeScheduler *instance();
+
+    // Returns the id used by the other calls
+    int add(const Probe &probe, bool enabled = true);
+    void remove(int id);
+    void setEnabled(int id, bool enabled);
+
+    // Run a probe now, e.g. when its panel is opened, unless it is already in flight
+    void trigger(int id);
+
+    // Worker pool for short one-off background jobs that should share the probe
+    // threads. Work that blocks for long, e.g. on a child process, needs its own.
+    QThreadPool *workerPool();
+
+    // While idle probes run at their idle period or not at all. Probes that fell
+    // due meanwhile catch up shortly after leaving idle, not in the first frame.
+    void setIdle(bool idle);
+    bool isIdle() const;
+
+    // Timer wakeups since startup
+    quint64 wakeups() const;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void wake();
+
+private:
+    explicit ProbeScheduler(QObject *parent = nullptr);
+    ~ProbeScheduler();
+
+    struct Entry
+    {
+        Probe probe;
+        qint64 deadline = 0;
+        bool enabled = true;
+        bool running = false;
+    };
+
+    void dispatch(int id);
+    void reschedule();
+
+    // The period the entry runs at now, 0 while it is paused or its widget is hidden
+    int period(const Entry &entry) const;
+
+    QHash<int, Entry> entries;
+    int lastId;
+    QTimer *timer;
+    QElapsedTimer clock;
+    QThreadPool pool;
+    quint64 wakeupCount;
+    bool idle;
+};
+
+#endif // PROBESCHEDULER_H
@@ -0,0 +1,196 @@
+#include "SecurityCollectors.h"
+#include "Trace.h"
+#include "SocketTable.h"
+#include "CommandStats.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+
+// How long a result stays fresh, indexed by SecurityCollectors::Collector
+const qint64 timeToLive[SecurityCollectors::CollectorCount] = {
+    15 * 1000,      // Listening sockets change whenever a service starts or stops
+    30 * 60 * 1000, // The apt simulation is slow and its answer rarely changes
+    5 * 60 * 1000   // Last login
+};
+
+// Set when the application goes down, running collectors give up within PollMs
+std::atomic<bool> shuttingDown(false);
+const int PollMs = 100;
+
+// Run a shell pipeline on the calling (worker) thread and return its output
+QByteArray runShell(const QString &command, int timeoutMs)
+{
+    const QStringList arguments = QStringList() << "-c" << command;
+    const QString key = CommandStats::commandKey("sh", arguments);
+    QElapsedTimer started;
+    started.start();
+
+    QProcess process;
+    process.start("sh", arguments);
+
+    // Wait in slices so shutting down never waits on a slow command
+    bool finished = false;
+    while (!finished && process.state() != QProcess::NotRunning &&
+           started.elapsed() < timeoutMs && !shuttingDown)
+    {
+        finished = process.waitForFinished(PollMs);
+    }
+    if (!finished)
+    {
+        if (process.state() != QProcess::NotRunning)
+        {
+            qDebug() << "Security collector" << (shuttingDown ? "cancelled:" : "timed out:") << command;
+            process.kill();
+            process.waitForFinished();
+        }
+        else
+        {
+            qDebug() << "Security collector failed to start:" << command;
+        }
+        CommandStats::instance()->record(key, started.nsecsElapsed() / 1000, -1, 0);
+        return QByteArray();
+    }
+
+    QByteArray output = process.readAllStandardOutput();
+    const int exitCode = process.exitStatus() == QProcess::NormalExit ? process.exitCode() : -1;
+    CommandStats::instance()->record(key, started.nsecsElapsed() / 1000, exitCode, output.size());
+    return output;
+}
+
+} // namespace
+
+SecurityCollectors *SecurityCollectors::instance()
+{
+    static SecurityCollectors *collectors = new SecurityCollectors(qApp);
+    return collectors;
+}
+
+SecurityCollectors::SecurityCollectors(QObject *parent)
+    : QObject(parent)
+{
+    // One thread per collector, refreshAll() never queues one behind another
+    pool.setMaxThreadCount(CollectorCount);
+}
+
+// Destructor
+SecurityCollectors::~SecurityCollectors()
+{
+    // Don't hold up exit for the apt simulation, its children are killed instead
+    shuttingDown = true;
+    pool.waitForDone();
+}
+
+QStringList SecurityCollectors::cached(Collector collector) const
+{
+    return entries[collector].lines;
+}
+
+bool SecurityCollectors::hasResult(Collector collector) const
+{
+    return entries[collector].age.isValid();
+}
+
+bool SecurityCollectors::isFresh(Collector collector) const
+{
+    const Entry &entry = entries[collector];
+    return entry.age.isValid() && entry.age.elapsed() < timeToLive[collector];
+}
+
+void SecurityCollectors::refresh(Collector collector)
+{
+    Entry &entry = entries[collector];
+    if (entry.running || isFresh(collector))
+    {
+        return;
+    }
+    entry.running = true;
+
+    QFutureWatcher<QStringList> *watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher, collector]() {
+        Entry &entry = entries[collector];
+        entry.lines = watcher->result();
+        entry.age.start();
+        entry.running = false;
+        watcher->deleteLater();
+
+        emit collected(collector);
+    });
+    watcher->setFuture(QtConcurrent::run(&pool, &SecurityCollectors::collect, collector));
+}
+
+void SecurityCollectors::refreshAll()
+{
+    for (int i = 0; i < CollectorCount; ++i)
+    {
+        refresh(Collector(i));
+    }
+}
+
+QStringList SecurityCollectors::collect(Collector collector)
+{
+    TRACE_SCOPE("SecurityCollectors::collect");
+
+    switch (collector)
+    {
+    case ListeningSockets:
+    {
+        SocketTable table;
+        if (table.readProc())
+        {
+            return table.toLines();
+        }
+
+        // Only shell out to ss where /proc/net is not available
+        return parseSsOutput(QString::fromLocal8Bit(runShell("ss -tuln", 5000)));
+    }
+
+    case AvailableUpdates:
+    {
+        // Check for available system updates
+        QString updates = QString::fromLocal8Bit(runShell("apt -s upgrade | grep 'newly installed' | awk '{print $1}'", 120000)).trimmed();
+        return QStringList() << QString("Available updates: %1").arg(updates.isEmpty() ? "0" : updates);
+    }
+
+    case LastLogin:
+    {
+        // Display last system login
+        QString lastLogin = QString::fromLocal8Bit(runShell("last -1 -R | head -1", 5000)).trimmed();
+        return QStringList() << QString("Last login: %1").arg(lastLogin);
+    }
+
+    default:
+        return QStringList();
+    }
+}
+
+QStringList SecurityCollectors::parseSsOutput(const QString &output)
+{
+    static const QRegularExpression spaceSplit("\\s+");
+
+    QStringList connections;
+    QStringList connectionLines = output.trimmed().split('\n', Qt::SkipEmptyParts);
+    for (int i = 1; i < connectionLines.size(); ++i) { // Skip header
+        QStringList parts = connectionLines[i].split(spaceSplit, Qt::SkipEmptyParts);
+        if (parts.size() >= 6) {
+            QString netid = parts[0];
+            QString state = parts[1];
+            QString localAddress = parts[4];
+
+            // Extract port number from localAddress
+            int colonIndex = localAddress.lastIndexOf(':');
+            QString port = colonIndex != -1 ? localAddress.mid(colonIndex + 1) : "N/A";
+
+            connections.append(QString("Port: %1, Netid: %2, State: %3")
+                                   .arg(port, netid, state));
+        }
+    }
+    return connections;
+}
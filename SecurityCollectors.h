@@ -0,0 +1,65 @@
+#ifndef SECURITYCOLLECTORS_H
+#define SECURITYCOLLECTORS_H
+
+#include <QObject>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+// Collects the details shown in the Security panel on worker threads and keeps
+// the last result of each collector, so the panel can open with cached values
+// and fill in fresher ones as they arrive.
+class SecurityCollectors : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Collector
+    {
+        ListeningSockets,
+        AvailableUpdates,
+        LastLogin,
+        CollectorCount
+    };
+    Q_ENUM(Collector)
+
+    // Shared by every SecurityControls instance, owned by the application
+    static SecurityCollectors *instance();
+
+    // Lines of the last finished run, empty until the first run finishes
+    QStringList cached(Collector collector) const;
+    bool hasResult(Collector collector) const;
+    bool isFresh(Collector collector) const;
+
+    // Start a background run unless the cached result is still fresh or a run is in flight
+    void refresh(Collector collector);
+    void refreshAll();
+
+    // Turn `ss -tuln` output into the panel's connection lines
+    static QStringList parseSsOutput(const QString &output);
+
+signals:
+    void collected(SecurityCollectors::Collector collector);
+
+private:
+    explicit SecurityCollectors(QObject *parent = nullptr);
+    ~SecurityCollectors();
+
+    // Runs on a worker thread
+    static QStringList collect(Collector collector);
+
+    struct Entry
+    {
+        QStringList lines;
+        QElapsedTimer age;
+        bool running = false;
+    };
+
+    Entry entries[CollectorCount];
+
+    // Collectors block on their commands for up to minutes, so they get
+    // threads of their own rather than holding up the probe pool
+    QThreadPool pool;
+};
+
+#endif // SECURITYCOLLECTORS_H
@@ -1,21 +1,32 @@
 #include "SecurityControls.h"
 #include "ToggleButton.h"
+#include "DetailView.h"
+#include "SecurityCollectors.h"
+#include "ProbeEngine.h"
+#include "SystemdUnitWatcher.h"
+#include "SystemBus.h"
+#include "ProbeScheduler.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
 #include <QStringList>
-#include <QProcess>
-#include <QRegularExpression>
 #include <QDebug>
 
 SecurityControls::SecurityControls(QWidget *parent)
     : QWidget(parent),
     optionPanelLayout(new QVBoxLayout(this)),
-    firewallCheckTimer(new QTimer(this)),
-    lastKnownFirewallState(false)
+    lastKnownFirewallState(false),
+    requestedFirewallState(false),
+    probes(new ProbeEngine(this)),
+    firewallUnit(new SystemdUnitWatcher("ufw.service", SystemBus::connection(), this)),
+    firewallProbe(0),
+    active(false)
 {
+    TRACE_SCOPE("SecurityControls::SecurityControls");
+
     setLayout(optionPanelLayout);
     optionPanelLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
 
     QLabel *titleLabel = new QLabel("Security", this);
-    titleLabel->setStyleSheet("background-color: transparent; color: white;");
     QFont titleFont = titleLabel->font();
     titleFont.setPointSize(30);
     titleFont.setFamily("Arial");
@@ -29,82 +40,115 @@ SecurityControls::SecurityControls(QWidget *parent)
     optionPanelLayout->addSpacing(40);
     optionPanelLayout->addWidget(firewallToggle);
     optionPanelLayout->addSpacing(40);
-    displaySecurityDetails();
     optionPanelLayout->setContentsMargins(25, 25, 0, 0);
 
-    checkFirewallState();
+    // Show whatever is cached straight away and refresh stale collectors in the background
+    detailView = new DetailView(this);
+    optionPanelLayout->addWidget(detailView);
+    displaySecurityDetails();
+
+    SecurityCollectors *collectors = SecurityCollectors::instance();
+    connect(collectors, &SecurityCollectors::collected, this, &SecurityControls::displaySecurityDetails);
+    collectors->refreshAll();
+
     connect(firewallToggle, &ToggleButton::toggled, this, &SecurityControls::handleFirewallToggle);
-    connect(firewallCheckTimer, &QTimer::timeout, this, &SecurityControls::checkFirewallState);
-    firewallCheckTimer->start(5000);
+    connect(probes, &ProbeEngine::probeFinished, this, &SecurityControls::handleProbeFinished);
+    connect(probes, &ProbeEngine::probeFailed, this, &SecurityControls::handleProbeFailed);
+
+    // Polling systemctl is only the fallback for while ufw.service cannot be followed.
+    // systemctl already runs asynchronously, the probe only needs to start it.
+    ProbeScheduler::Probe probe;
+    probe.name = "firewall";
+    probe.periodMs = 5000;
+    probe.toleranceMs = 1000;
+    probe.context = this;
+    probe.onlyWhileVisible = true;
+    probe.deliver = [this](const QVariant &) {
+        checkFirewallState();
+    };
+    firewallProbe = ProbeScheduler::instance()->add(probe);
+
+    // Follow ufw.service through systemd's signals whenever they can be had
+    connect(firewallUnit, &SystemdUnitWatcher::watchingChanged, this, [this](bool watching) {
+        ProbeScheduler::instance()->setEnabled(firewallProbe, !watching);
+        checkFirewallState();
+    });
+    connect(firewallUnit, &SystemdUnitWatcher::activeStateChanged, this, [this](const QString &state) {
+        // Ignore transitions such as "activating", only settled states move the toggle
+        if (state == "active") {
+            applyFirewallState(true);
+        } else if (state == "inactive" || state == "failed") {
+            applyFirewallState(false);
+        }
+    });
+    firewallUnit->start();
+    checkFirewallState();
+}
+
+void SecurityControls::setActive(bool active)
+{
+    StallWatchdog::Scope stallScope("SecurityControls::setActive");
+    TRACE_SCOPE("SecurityControls::setActive");
+
+    if (active == this->active)
+    {
+        return;
+    }
+    this->active = active;
+
+    if (active)
+    {
+        // The instance is reused between taps, collectors older than their TTL are rerun
+        SecurityCollectors::instance()->refreshAll();
+        displaySecurityDetails();
+        checkFirewallState();
+    }
 }
 
 void SecurityControls::displaySecurityDetails()
 {
-    QStringList securityDetailsList;
+    StallWatchdog::Scope stallScope("SecurityControls::displaySecurityDetails");
+    TRACE_SCOPE("SecurityControls::displaySecurityDetails");
+
+    SecurityCollectors *collectors = SecurityCollectors::instance();
+
     // List network connections
-    QProcess ssProcess;
-    ssProcess.start("sh", QStringList() << "-c" << "ss -tuln");
-    ssProcess.waitForFinished();
-    QString connections = ssProcess.readAllStandardOutput().trimmed();
-    QStringList connectionLines = connections.split('\n', Qt::SkipEmptyParts);
+    QStringList securityDetailsList;
     securityDetailsList.append("Network connections:");
-    static const QRegularExpression spaceSplit("\\s+");
-    for (int i = 1; i < connectionLines.size(); ++i) { // Skip header
-        QStringList parts = connectionLines[i].split(spaceSplit, Qt::SkipEmptyParts);
-        if (parts.size() >= 6) {
-            QString netid = parts[0];
-            QString state = parts[1];
-            QString localAddress = parts[4];
-
-            // Extract port number from localAddress
-            int colonIndex = localAddress.lastIndexOf(':');
-            QString port = colonIndex != -1 ? localAddress.mid(colonIndex + 1) : "N/A";
-
-            securityDetailsList.append(QString("Port: %1, Netid: %2, State: %3")
-                                           .arg(port, netid, state));
-        }
-    }
+    securityDetailsList.append(collectors->cached(SecurityCollectors::ListeningSockets));
 
-    // Check for available system updates
-    QProcess updatesProcess;
-    updatesProcess.start("sh", QStringList() << "-c" << "apt -s upgrade | grep 'newly installed' | awk '{print $1}'");
-    updatesProcess.waitForFinished();
-    QString updates = updatesProcess.readAllStandardOutput().trimmed();
-    securityDetailsList.append(QString("Available updates: %1").arg(updates == "" ? "0" : updates));
-
-    // Display last system login
-    QProcess lastLoginProcess;
-    lastLoginProcess.start("sh", QStringList() << "-c" << "last -1 -R | head -1");
-    lastLoginProcess.waitForFinished();
-    QString lastLogin = lastLoginProcess.readAllStandardOutput().trimmed();
-    securityDetailsList.append(QString("Last login: %1").arg(lastLogin));
-
-    // Clear existing labels
-    QLayoutItem *child;
-    while ((child = optionPanelLayout->takeAt(4)) != nullptr) {
-        delete child->widget();
-        delete child;
+    // Placeholders until the first run of a collector has finished
+    if (collectors->hasResult(SecurityCollectors::AvailableUpdates)) {
+        securityDetailsList.append(collectors->cached(SecurityCollectors::AvailableUpdates));
+    } else {
+        securityDetailsList.append("Available updates: checking...");
     }
 
-    for (const QString &detail : securityDetailsList)
-    {
-        QLabel *label = new QLabel(detail, this);
-        label->setStyleSheet("background-color: transparent; color: white;");
-        QFont font = label->font();
-        font.setPointSize(16);
-        font.setFamily("Arial");
-        label->setFont(font);
-        optionPanelLayout->addWidget(label);
+    if (collectors->hasResult(SecurityCollectors::LastLogin)) {
+        securityDetailsList.append(collectors->cached(SecurityCollectors::LastLogin));
+    } else {
+        securityDetailsList.append("Last login: checking...");
     }
+
+    detailView->setLines(securityDetailsList);
 }
 
 void SecurityControls::checkFirewallState()
 {
-    QProcess process;
-    process.start("systemctl", QStringList() << "is-active" << "ufw");
-    process.waitForFinished();
-    bool isEnabled = (process.readAllStandardOutput().trimmed() == "active");
+    StallWatchdog::Scope stallScope("SecurityControls::checkFirewallState");
+    TRACE_SCOPE("SecurityControls::checkFirewallState");
+
+    if (firewallUnit->isWatching()) {
+        applyFirewallState(firewallUnit->isActive());
+        return;
+    }
+
+    // ufw.service is not followed through systemd, ask systemctl instead
+    probes->run("state", "systemctl", QStringList() << "is-active" << "ufw", 2000);
+}
 
+void SecurityControls::applyFirewallState(bool isEnabled)
+{
     if (isEnabled != lastKnownFirewallState) {
         lastKnownFirewallState = isEnabled;
         firewallToggle->setToggleState(isEnabled);
@@ -113,22 +157,67 @@ void SecurityControls::checkFirewallState()
 
 void SecurityControls::handleFirewallToggle(bool enabled)
 {
+    StallWatchdog::Scope stallScope("SecurityControls::handleFirewallToggle");
+    TRACE_SCOPE("SecurityControls::handleFirewallToggle");
+
     if (enabled == lastKnownFirewallState) {
         return;
     }
 
-    QProcess process;
+    if (probes->isRunning("toggle")) {
+        // Keep showing the state that is still being applied
+        firewallToggle->setToggleState(requestedFirewallState);
+        return;
+    }
+
+    // A state check racing the toggle would report the old state
+    probes->cancel("state");
+
+    requestedFirewallState = enabled;
     QString command = enabled ? "start" : "stop";
 
-    process.start("pkexec", QStringList() << "systemctl" << command << "ufw");
-    process.waitForFinished();
+    // pkexec waits for the user to authenticate, so allow plenty of time
+    probes->run("toggle", "pkexec", QStringList() << "systemctl" << command << "ufw", 120000);
+}
+
+void SecurityControls::applyFirewallToggleResult(bool succeeded, const QString &error)
+{
+    bool enabled = requestedFirewallState;
 
-    if (process.exitCode() == 0) {
+    if (succeeded) {
         qDebug() << "Firewall successfully" << (enabled ? "enabled" : "disabled");
         lastKnownFirewallState = enabled;
-        checkFirewallState();
+
+        // A watched unit confirms the state through its own signal, reading
+        // it now could still return the state from before the toggle
+        if (!firewallUnit->isWatching()) {
+            checkFirewallState();
+        }
     } else {
-        qDebug() << "Failed to change firewall state:" << process.readAllStandardError();
+        qDebug() << "Failed to change firewall state:" << error;
         firewallToggle->setToggleState(!enabled);  // Revert the toggle state
     }
 }
+
+void SecurityControls::handleProbeFinished(const QString &key, int exitCode, const QByteArray &output)
+{
+    StallWatchdog::Scope stallScope("SecurityControls::handleProbeFinished");
+    TRACE_SCOPE("SecurityControls::handleProbeFinished");
+
+    if (key == "state") {
+        if (!probes->isRunning("toggle")) {
+            applyFirewallState(output.trimmed() == "active");
+        }
+    } else if (key == "toggle") {
+        applyFirewallToggleResult(exitCode == 0, QString("pkexec exited with code %1").arg(exitCode));
+    }
+}
+
+void SecurityControls::handleProbeFailed(const QString &key, const QString &reason)
+{
+    qDebug() << "Security probe" << key << "failed:" << reason;
+
+    if (key == "toggle") {
+        applyFirewallToggleResult(false, reason);
+    }
+}
@@ -4,9 +4,11 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QLabel>
-#include <QTimer>
 
 class ToggleButton;
+class DetailView;
+class ProbeEngine;
+class SystemdUnitWatcher;
 
 class SecurityControls : public QWidget
 {
@@ -15,17 +17,32 @@ class SecurityControls : public QWidget
 public:
     explicit SecurityControls(QWidget *parent = nullptr);
 
+    // Refresh stale details and the firewall state when the panel is opened
+    void setActive(bool active);
+
 private slots:
     void checkFirewallState();
     void handleFirewallToggle(bool enabled);
 
+    // Probe result handlers
+    void handleProbeFinished(const QString &key, int exitCode, const QByteArray &output);
+    void handleProbeFailed(const QString &key, const QString &reason);
+
 private:
     void displaySecurityDetails();
+    void applyFirewallState(bool isEnabled);
+    void applyFirewallToggleResult(bool succeeded, const QString &error);
 
     QVBoxLayout *optionPanelLayout;
     ToggleButton *firewallToggle;
-    QTimer *firewallCheckTimer;
+    DetailView *detailView;
     bool lastKnownFirewallState;
+    bool requestedFirewallState;
+
+    ProbeEngine *probes;
+    SystemdUnitWatcher *firewallUnit;
+    int firewallProbe; // systemctl polling while firewallUnit is not watching
+    bool active;
 };
 
 #endif // SECURITYCONTROLS_H
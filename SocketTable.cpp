@@ -0,0 +1,182 @@
+#include "SocketTable.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Value of a hex digit, or -1
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Parse hex digits starting at cursor, stops at the first non hex character
+inline unsigned int parseHex(const char *&cursor, const char *end)
+{
+    unsigned int value = 0;
+    int digit;
+    while (cursor < end && (digit = hexValue(*cursor)) >= 0)
+    {
+        value = (value << 4) | unsigned(digit);
+        ++cursor;
+    }
+    return value;
+}
+
+inline void skipSpaces(const char *&cursor, const char *end)
+{
+    while (cursor < end && *cursor == ' ')
+    {
+        ++cursor;
+    }
+}
+
+// Skip an address:port column, returns the port
+inline unsigned int parseEndpoint(const char *&cursor, const char *end)
+{
+    while (cursor < end && *cursor != ':' && *cursor != '\n')
+    {
+        ++cursor;
+    }
+    if (cursor < end && *cursor == ':')
+    {
+        ++cursor;
+    }
+    return parseHex(cursor, end);
+}
+
+const char *const netidNames[] = {"tcp", "tcp", "udp", "udp"};
+
+} // namespace
+
+void SocketTable::clear()
+{
+    ports.clear();
+    protocols.clear();
+    states.clear();
+}
+
+int SocketTable::size() const
+{
+    return int(ports.size());
+}
+
+bool SocketTable::readProc()
+{
+    clear();
+
+    // Same order ss prints them in
+    static const struct { const char *path; Protocol protocol; } tables[] = {
+        {"/proc/net/udp", Udp},
+        {"/proc/net/udp6", Udp6},
+        {"/proc/net/tcp", Tcp},
+        {"/proc/net/tcp6", Tcp6}
+    };
+
+    bool anyRead = false;
+    for (const auto &table : tables)
+    {
+        // IPv6 tables are missing when IPv6 is disabled, that is not an error
+        if (readFile(table.path))
+        {
+            anyRead = true;
+            parse(buffer.constData(), buffer.size(), table.protocol);
+        }
+    }
+    return anyRead;
+}
+
+bool SocketTable::readFile(const char *path)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // procfs reports a size of 0, so read until end of file
+    qsizetype used = 0;
+    if (buffer.size() < 65536)
+    {
+        buffer.resize(65536);
+    }
+    for (;;)
+    {
+        if (used == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t count = ::read(fd, buffer.data() + used, size_t(buffer.size() - used));
+        if (count <= 0)
+        {
+            break;
+        }
+        used += count;
+    }
+    ::close(fd);
+
+    buffer.truncate(used);
+    return true;
+}
+
+void SocketTable::parse(const char *data, qsizetype size, Protocol protocol)
+{
+    const char *cursor = data;
+    const char *end = data + size;
+    const bool isTcp = (protocol == Tcp || protocol == Tcp6);
+
+    // Skip the header line
+    while (cursor < end && *cursor++ != '\n')
+    {
+    }
+
+    while (cursor < end)
+    {
+        // "  sl: local_address rem_address st ..."
+        while (cursor < end && *cursor != ':' && *cursor != '\n')
+        {
+            ++cursor;
+        }
+        if (cursor < end && *cursor == ':')
+        {
+            ++cursor;
+            skipSpaces(cursor, end);
+            unsigned int localPort = parseEndpoint(cursor, end);
+            skipSpaces(cursor, end);
+            parseEndpoint(cursor, end);
+            skipSpaces(cursor, end);
+            unsigned int state = parseHex(cursor, end);
+
+            // ss -l shows listening TCP sockets and unconnected UDP sockets
+            if ((isTcp && state == Listen) || (!isTcp && state == Close))
+            {
+                ports.append(quint16(localPort));
+                protocols.append(protocol);
+                states.append(State(state));
+            }
+        }
+
+        // Next line
+        while (cursor < end && *cursor++ != '\n')
+        {
+        }
+    }
+}
+
+QStringList SocketTable::toLines() const
+{
+    QStringList lines;
+    lines.reserve(ports.size());
+    for (qsizetype i = 0; i < ports.size(); ++i)
+    {
+        lines.append(QString("Port: %1, Netid: %2, State: %3")
+                         .arg(QString::number(ports.at(i)),
+                              QLatin1String(netidNames[protocols.at(i)]),
+                              QLatin1String(states.at(i) == Listen ? "LISTEN" : "UNCONN")));
+    }
+    return lines;
+}
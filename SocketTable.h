@@ -0,0 +1,52 @@
+#ifndef SOCKETTABLE_H
+#define SOCKETTABLE_H
+
+#include <QList>
+#include <QByteArray>
+#include <QStringList>
+
+// Listening sockets read straight from /proc/net/{tcp,udp}{,6}, the same set
+// `ss -tuln` reports. Entries are kept as parallel arrays so parsing a large
+// table never allocates per line.
+class SocketTable
+{
+public:
+    enum Protocol : quint8
+    {
+        Tcp,
+        Tcp6,
+        Udp,
+        Udp6
+    };
+
+    // Kernel socket states that count as listening
+    enum State : quint8
+    {
+        Close = 0x07,  // Unconnected UDP, shown as UNCONN
+        Listen = 0x0A
+    };
+
+    void clear();
+    int size() const;
+
+    // Read all four tables, returns false when /proc/net cannot be read
+    bool readProc();
+
+    // Append the listening entries of one /proc/net table
+    void parse(const char *data, qsizetype size, Protocol protocol);
+
+    // Lines for the Security panel, same wording as the ss based parser
+    QStringList toLines() const;
+
+    QList<quint16> ports;
+    QList<Protocol> protocols;
+    QList<State> states;
+
+private:
+    bool readFile(const char *path);
+
+    // Reused between reads so refreshing the table does not reallocate
+    QByteArray buffer;
+};
+
+#endif // SOCKETTABLE_H
@@ -0,0 +1,246 @@
+#include "StallWatchdog.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+
+// Innermost Scope open on the GUI thread
+std::atomic<const char *> currentSite{nullptr};
+
+StallWatchdog *watchdog = nullptr;
+
+bool isGuiThread()
+{
+    QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+} // namespace
+
+StallWatchdog::Scope::Scope(const char *site)
+    : previous(nullptr),
+    onGuiThread(isGuiThread())
+{
+    if (onGuiThread)
+    {
+        previous = currentSite.exchange(site, std::memory_order_relaxed);
+    }
+}
+
+// Destructor
+StallWatchdog::Scope::~Scope()
+{
+    if (onGuiThread)
+    {
+        currentSite.store(previous, std::memory_order_relaxed);
+    }
+}
+
+StallWatchdog *StallWatchdog::startFromEnvironment()
+{
+    if (watchdog)
+    {
+        return watchdog;
+    }
+
+    bool ok = false;
+    int thresholdMs = qEnvironmentVariableIntValue("HOMESCREEN_STALL_WATCHDOG", &ok);
+    if (!ok || thresholdMs <= 0)
+    {
+        return nullptr;
+    }
+
+    watchdog = new StallWatchdog(thresholdMs, qApp);
+    watchdog->start(QThread::LowPriority);
+    qDebug() << "Stall watchdog running with a" << thresholdMs << "ms threshold";
+    return watchdog;
+}
+
+StallWatchdog *StallWatchdog::instance()
+{
+    return watchdog;
+}
+
+StallWatchdog::StallWatchdog(int thresholdMs, QObject *parent)
+    : QThread(parent),
+    thresholdMs(thresholdMs),
+    stopping(false),
+    pingSentAt(-1),
+    stallSite(nullptr),
+    next(0),
+    count(0),
+    longestMs(0),
+    totalMs(0)
+{
+    clock.start();
+    ring.reserve(Capacity);
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        exportTo();
+    });
+}
+
+// Destructor
+StallWatchdog::~StallWatchdog()
+{
+    stopping = true;
+    wait();
+    watchdog = nullptr;
+}
+
+int StallWatchdog::threshold() const
+{
+    return thresholdMs;
+}
+
+quint64 StallWatchdog::stallCount() const
+{
+    QMutexLocker locker(&mutex);
+    return count;
+}
+
+qint64 StallWatchdog::longestStallMs() const
+{
+    QMutexLocker locker(&mutex);
+    return longestMs;
+}
+
+qint64 StallWatchdog::totalStallMs() const
+{
+    QMutexLocker locker(&mutex);
+    return totalMs;
+}
+
+QList<StallWatchdog::Stall> StallWatchdog::stalls() const
+{
+    QMutexLocker locker(&mutex);
+    if (ring.size() < Capacity)
+    {
+        return ring;
+    }
+    return ring.mid(next) + ring.mid(0, next);
+}
+
+QStringList StallWatchdog::summaryLines() const
+{
+    const QList<Stall> recent = stalls();
+
+    QStringList lines;
+    lines.append(QString("GUI stalls over %1 ms: %2, longest %3 ms, total %4 ms")
+                     .arg(thresholdMs)
+                     .arg(stallCount())
+                     .arg(longestStallMs())
+                     .arg(totalStallMs()));
+
+    // Newest first
+    for (int i = recent.size() - 1; i >= 0 && i >= recent.size() - 5; --i)
+    {
+        const Stall &stall = recent.at(i);
+        lines.append(QString("  %1 ms in %2 at %3")
+                         .arg(stall.durationMs)
+                         .arg(stall.site ? stall.site : "unknown")
+                         .arg(QDateTime::fromMSecsSinceEpoch(stall.startedAt).toString("hh:mm:ss")));
+    }
+    return lines;
+}
+
+bool StallWatchdog::exportTo(const QString &path) const
+{
+    QString target = path;
+    if (target.isEmpty())
+    {
+        target = qEnvironmentVariable("HOMESCREEN_STALL_LOG");
+    }
+    if (target.isEmpty())
+    {
+        target = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/stalls.csv";
+    }
+
+    QByteArray csv("started,duration_ms,site\n");
+    const QList<Stall> recent = stalls();
+    for (const Stall &stall : recent)
+    {
+        csv += QDateTime::fromMSecsSinceEpoch(stall.startedAt).toString(Qt::ISODateWithMs).toUtf8();
+        csv += ',' + QByteArray::number(stall.durationMs);
+        csv += ',' + QByteArray(stall.site ? stall.site : "unknown") + '\n';
+    }
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Failed to write stalls to" << target << ":" << file.errorString();
+        return false;
+    }
+    file.write(csv);
+    return file.commit();
+}
+
+void StallWatchdog::run()
+{
+    // Check a few times per threshold so a stall is caught while it is still going on
+    const int interval = qBound(5, thresholdMs / 4, 100);
+
+    while (!stopping)
+    {
+        const qint64 now = clock.elapsed();
+        const qint64 sent = pingSentAt.load();
+
+        if (sent < 0)
+        {
+            stallSite.store(nullptr);
+            pingSentAt.store(now);
+            QMetaObject::invokeMethod(this, [this, now]() {
+                pong(now);
+            }, Qt::QueuedConnection);
+        }
+        else if (now - sent >= thresholdMs)
+        {
+            // Remember the first site seen while the GUI thread is stuck
+            const char *expected = nullptr;
+            stallSite.compare_exchange_strong(expected, currentSite.load(std::memory_order_relaxed));
+        }
+
+        msleep(interval);
+    }
+}
+
+void StallWatchdog::pong(qint64 sentAt)
+{
+    const qint64 latency = clock.elapsed() - sentAt;
+    pingSentAt.store(-1);
+    const char *site = stallSite.exchange(nullptr);
+
+    if (latency < thresholdMs)
+    {
+        return;
+    }
+
+    Stall stall;
+    stall.startedAt = QDateTime::currentMSecsSinceEpoch() - latency;
+    stall.durationMs = latency;
+    stall.site = site;
+
+    qDebug() << "GUI thread stalled for" << latency << "ms in" << (site ? site : "unknown");
+
+    QMutexLocker locker(&mutex);
+    if (ring.size() < Capacity)
+    {
+        ring.append(stall);
+    }
+    else
+    {
+        ring[next] = stall;
+    }
+    next = (next + 1) % Capacity;
+    ++count;
+    longestMs = qMax(longestMs, latency);
+    totalMs += latency;
+}
@@ -0,0 +1,87 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QList>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <atomic>
+
+// Watches the GUI event loop from its own thread. A ping is queued to the GUI
+// thread every few milliseconds; when it is not answered within the threshold
+// the loop is stalled, and the call site that was running at the time is taken
+// from the innermost Scope on the GUI thread. Finished stalls are kept in a
+// ring buffer that can be exported.
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Stall
+    {
+        qint64 startedAt = 0;       // ms since the epoch
+        qint64 durationMs = 0;
+        const char *site = nullptr; // null when no Scope was open
+    };
+
+    // Marks the call site running on the GUI thread, does nothing on other threads.
+    // Cheap enough to leave in place when the watchdog is not running.
+    class Scope
+    {
+    public:
+        explicit Scope(const char *site);
+        ~Scope();
+
+    private:
+        const char *previous;
+        bool onGuiThread;
+    };
+
+    // Started when HOMESCREEN_STALL_WATCHDOG is set to a threshold in ms, null otherwise
+    static StallWatchdog *startFromEnvironment();
+    static StallWatchdog *instance();
+
+    int threshold() const;
+    quint64 stallCount() const;
+    qint64 longestStallMs() const;
+    qint64 totalStallMs() const;
+
+    // Most recent stalls, oldest first
+    QList<Stall> stalls() const;
+
+    // Counters and the last few stalls, for the debug overlay
+    QStringList summaryLines() const;
+
+    // Write the ring buffer as CSV, the default path comes from HOMESCREEN_STALL_LOG
+    bool exportTo(const QString &path = QString()) const;
+
+protected:
+    void run() override;
+
+private:
+    explicit StallWatchdog(int thresholdMs, QObject *parent = nullptr);
+    ~StallWatchdog();
+
+    // Runs on the GUI thread when a ping gets through
+    void pong(qint64 sentAt);
+
+    static const int Capacity = 256;
+
+    const int thresholdMs;
+    QElapsedTimer clock;
+    std::atomic<bool> stopping;
+
+    // Shared between the watchdog and the GUI thread
+    std::atomic<qint64> pingSentAt;        // -1 while no ping is outstanding
+    std::atomic<const char *> stallSite;   // site seen while the current ping is overdue
+
+    mutable QMutex mutex;
+    QList<Stall> ring;
+    int next;
+    quint64 count;
+    qint64 longestMs;
+    qint64 totalMs;
+};
+
+#endif // STALLWATCHDOG_H
@@ -0,0 +1,108 @@
+#include "StaticTextLabel.h"
+#include "Theme.h"
+
+#include <QEvent>
+#include <QFontMetrics>
+#include <QPainter>
+
+namespace {
+
+// Room for antialiasing and kerning across the edge of a changed span
+const int SpanMargin = 2;
+
+} // namespace
+
+StaticTextLabel::StaticTextLabel(const QString &text, QWidget *parent)
+    : QWidget(parent),
+    staticText(text)
+{
+    staticText.setTextFormat(Qt::PlainText);
+    prepare();
+}
+
+void StaticTextLabel::setText(const QString &text)
+{
+    const QString previous = staticText.text();
+    if (text == previous)
+    {
+        return;
+    }
+
+    // Characters shared at the start and at the end are left as they are on screen
+    int first = 0;
+    const int shorter = qMin(text.size(), previous.size());
+    while (first < shorter && text.at(first) == previous.at(first))
+    {
+        ++first;
+    }
+    int common = 0;
+    while (common < shorter - first &&
+           text.at(text.size() - 1 - common) == previous.at(previous.size() - 1 - common))
+    {
+        ++common;
+    }
+
+    const QRect damaged = spanRect(previous, first, previous.size() - common)
+                              .united(spanRect(text, first, text.size() - common));
+
+    staticText.setText(text);
+    prepare();
+
+    // Grow to fit, the position stays where the owner put it
+    const QSize hint = sizeHint();
+    if (hint.width() > width() || hint.height() > height())
+    {
+        resize(hint.expandedTo(size()));
+        update();
+        return;
+    }
+    update(damaged);
+}
+
+QString StaticTextLabel::text() const
+{
+    return staticText.text();
+}
+
+QSize StaticTextLabel::sizeHint() const
+{
+    const QFontMetrics metrics(font());
+    return QSize(metrics.horizontalAdvance(staticText.text()) + SpanMargin, metrics.height());
+}
+
+void StaticTextLabel::paintEvent(QPaintEvent *)
+{
+    // Clipped to the damaged span, the rest of the prepared text is not rasterised
+    QPainter painter(this);
+    painter.setFont(font());
+    painter.setPen(Theme::color(Theme::Color::Text));
+    painter.drawStaticText(0, (height() - QFontMetrics(font()).height()) / 2, staticText);
+}
+
+void StaticTextLabel::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange)
+    {
+        prepare();
+        update();
+    }
+    QWidget::changeEvent(event);
+}
+
+QRect StaticTextLabel::spanRect(const QString &text, int first, int last) const
+{
+    if (last <= first)
+    {
+        return QRect();
+    }
+    const QFontMetrics metrics(font());
+    const int left = metrics.horizontalAdvance(text.left(first));
+    const int right = metrics.horizontalAdvance(text.left(last));
+    return QRect(left - SpanMargin, 0, right - left + 2 * SpanMargin, height());
+}
+
+void StaticTextLabel::prepare()
+{
+    // Lay the glyphs out now instead of on the first paint
+    staticText.prepare(QTransform(), font());
+}
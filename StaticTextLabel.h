@@ -0,0 +1,36 @@
+#ifndef STATICTEXTLABEL_H
+#define STATICTEXTLABEL_H
+
+#include <QWidget>
+#include <QStaticText>
+#include <QString>
+
+// One line of text in the theme's text colour, laid out once into a QStaticText.
+// setText() only invalidates the span of characters that differ from the last
+// text, so the clock going from 12:59 to 13:00 repaints "3:00" and not the whole
+// label, and the same text set again repaints nothing.
+class StaticTextLabel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StaticTextLabel(const QString &text, QWidget *parent = nullptr);
+
+    void setText(const QString &text);
+    QString text() const;
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    // Pixels covered by the characters from index first up to, not including, last
+    QRect spanRect(const QString &text, int first, int last) const;
+    void prepare();
+
+    QStaticText staticText;
+};
+
+#endif // STATICTEXTLABEL_H
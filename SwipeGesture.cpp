@@ -0,0 +1,156 @@
+#include "SwipeGesture.h"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QScreen>
+#include <QWidget>
+#include <cmath>
+
+namespace {
+
+// Only samples this recent count towards the release velocity
+const qint64 VelocityWindowMs = 100;
+
+} // namespace
+
+SwipeGesture::SwipeGesture(QWidget *target)
+    : QObject(target),
+    target(target),
+    pressed(false),
+    swiping(false),
+    pressY(0),
+    pendingDelta(0),
+    movePending(false),
+    sampleCount(0),
+    nextSample(0)
+{
+    frameTimer.setSingleShot(true);
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, &QTimer::timeout, this, &SwipeGesture::flush);
+
+    clock.start();
+    target->installEventFilter(this);
+}
+
+bool SwipeGesture::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched != target)
+    {
+        return false;
+    }
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+        if (mouseEvent->button() != Qt::LeftButton)
+        {
+            return false;
+        }
+        pressed = true;
+        swiping = false;
+        movePending = false;
+        sampleCount = 0;
+        pressY = mouseEvent->globalPosition().y();
+        addSample(pressY);
+
+        // One update per refresh of the screen the handle is on
+        const qreal refreshRate = target->screen() ? target->screen()->refreshRate() : 60;
+        frameTimer.setInterval(qMax(1, int(1000 / qMax<qreal>(refreshRate, 1))));
+        return true;
+    }
+    case QEvent::MouseMove:
+    {
+        if (!pressed)
+        {
+            return false;
+        }
+        const qreal y = static_cast<QMouseEvent*>(event)->globalPosition().y();
+        addSample(y);
+
+        const int delta = qRound(y - pressY);
+        if (!swiping && std::abs(delta) >= QApplication::startDragDistance())
+        {
+            swiping = true;
+            emit started();
+        }
+        if (swiping)
+        {
+            // Later moves in the same frame only replace the pending position
+            pendingDelta = delta;
+            movePending = true;
+            if (!frameTimer.isActive())
+            {
+                frameTimer.start();
+            }
+        }
+        return true;
+    }
+    case QEvent::MouseButtonRelease:
+    {
+        if (!pressed || static_cast<QMouseEvent*>(event)->button() != Qt::LeftButton)
+        {
+            return false;
+        }
+        pressed = false;
+        if (swiping)
+        {
+            const qreal y = static_cast<QMouseEvent*>(event)->globalPosition().y();
+            addSample(y);
+            frameTimer.stop();
+            flush();
+            swiping = false;
+            emit finished(qRound(y - pressY), velocity());
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void SwipeGesture::addSample(qreal y)
+{
+    samples[nextSample].timeMs = clock.elapsed();
+    samples[nextSample].y = y;
+    nextSample = (nextSample + 1) % SampleCount;
+    sampleCount = qMin(sampleCount + 1, SampleCount);
+}
+
+qreal SwipeGesture::velocity() const
+{
+    if (sampleCount < 2)
+    {
+        return 0;
+    }
+
+    // From the oldest sample inside the window to the newest one
+    const Sample &newest = samples[(nextSample + SampleCount - 1) % SampleCount];
+    const Sample *oldest = &newest;
+    for (int i = 2; i <= sampleCount; ++i)
+    {
+        const Sample &sample = samples[(nextSample + SampleCount - i) % SampleCount];
+        if (newest.timeMs - sample.timeMs > VelocityWindowMs)
+        {
+            break;
+        }
+        oldest = &sample;
+    }
+
+    const qint64 elapsedMs = newest.timeMs - oldest->timeMs;
+    if (elapsedMs <= 0)
+    {
+        return 0;
+    }
+    return (newest.y - oldest->y) * 1000.0 / elapsedMs;
+}
+
+void SwipeGesture::flush()
+{
+    if (movePending)
+    {
+        movePending = false;
+        emit moved(pendingDelta);
+    }
+}
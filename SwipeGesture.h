@@ -0,0 +1,60 @@
+#ifndef SWIPEGESTURE_H
+#define SWIPEGESTURE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QWidget;
+
+// Vertical swipe recogniser filtering the events of one widget only. Raw mouse
+// moves are compressed to at most one moved() per display frame, and the
+// release reports the finger's velocity so the receiver can tell a fling from
+// a slow drag.
+class SwipeGesture : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SwipeGesture(QWidget *target);
+
+signals:
+    // The press has moved past the drag distance
+    void started();
+
+    // Distance from the press, at most once per frame
+    void moved(int deltaY);
+
+    // Released after a swipe, velocity in px/s over the last moments, positive downwards
+    void finished(int deltaY, qreal velocity);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Sample
+    {
+        qint64 timeMs;
+        qreal y;
+    };
+
+    void addSample(qreal y);
+    qreal velocity() const;
+    void flush();
+
+    static const int SampleCount = 8;
+
+    QWidget *target;
+    QTimer frameTimer;
+    QElapsedTimer clock;
+    bool pressed;
+    bool swiping;
+    qreal pressY;
+    int pendingDelta;
+    bool movePending;
+    Sample samples[SampleCount];
+    int sampleCount;
+    int nextSample;
+};
+
+#endif // SWIPEGESTURE_H
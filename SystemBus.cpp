@@ -0,0 +1,12 @@
+#include "SystemBus.h"
+
+#include <QtGlobal>
+
+QDBusConnection SystemBus::connection()
+{
+    if (qEnvironmentVariableIsSet("HOMESCREEN_DBUS_SESSION"))
+    {
+        return QDBusConnection::sessionBus();
+    }
+    return QDBusConnection::systemBus();
+}
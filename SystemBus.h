@@ -0,0 +1,13 @@
+#ifndef SYSTEMBUS_H
+#define SYSTEMBUS_H
+
+#include <QDBusConnection>
+
+namespace SystemBus
+{
+// The system bus, or the session bus when HOMESCREEN_DBUS_SESSION is set so the
+// panel can be pointed at stand-in services without root or real hardware
+QDBusConnection connection();
+}
+
+#endif // SYSTEMBUS_H
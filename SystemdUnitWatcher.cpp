@@ -0,0 +1,219 @@
+#include "SystemdUnitWatcher.h"
+
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QDebug>
+
+namespace {
+
+const QString Service = "org.freedesktop.systemd1";
+const QString ManagerPath = "/org/freedesktop/systemd1";
+const QString ManagerInterface = "org.freedesktop.systemd1.Manager";
+const QString UnitInterface = "org.freedesktop.systemd1.Unit";
+const QString PropertiesInterface = "org.freedesktop.DBus.Properties";
+
+} // namespace
+
+SystemdUnitWatcher::SystemdUnitWatcher(const QString &unitName, const QDBusConnection &bus, QObject *parent)
+    : QObject(parent),
+    unitName(unitName),
+    bus(bus),
+    serviceWatcher(nullptr),
+    generation(0),
+    watching(false)
+{
+}
+
+bool SystemdUnitWatcher::start()
+{
+    if (serviceWatcher)
+    {
+        return true;
+    }
+    if (!bus.isConnected())
+    {
+        qDebug() << "No D-Bus connection, falling back to systemctl for" << unitName;
+        return false;
+    }
+
+    // NameOwnerChanged reports systemd appearing late or restarting
+    serviceWatcher = new QDBusServiceWatcher(Service, bus, QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged,
+            this, &SystemdUnitWatcher::serviceOwnerChanged);
+
+    // The current owner is asked for asynchronously, the GUI thread never waits on the bus
+    QDBusMessage call = QDBusMessage::createMethodCall("org.freedesktop.DBus", "/org/freedesktop/DBus",
+                                                       "org.freedesktop.DBus", "GetNameOwner");
+    call << Service;
+    QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(bus.asyncCall(call), this);
+    connect(callWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *finishedCall) {
+        QDBusPendingReply<QString> reply = *finishedCall;
+        finishedCall->deleteLater();
+
+        if (reply.isError())
+        {
+            qDebug() << "systemd is not on the bus, falling back to systemctl for" << unitName;
+            return;
+        }
+        // An owner change may have been seen first
+        if (owner.isEmpty())
+        {
+            serviceOwnerChanged(Service, QString(), reply.value());
+        }
+    });
+    return true;
+}
+
+bool SystemdUnitWatcher::isWatching() const
+{
+    return watching;
+}
+
+QString SystemdUnitWatcher::activeState() const
+{
+    return state;
+}
+
+bool SystemdUnitWatcher::isActive() const
+{
+    return state == "active";
+}
+
+void SystemdUnitWatcher::serviceOwnerChanged(const QString &, const QString &, const QString &newOwner)
+{
+    if (newOwner == owner)
+    {
+        return;
+    }
+
+    reset();
+    owner = newOwner;
+    if (owner.isEmpty())
+    {
+        qDebug() << "systemd left the bus, falling back to systemctl for" << unitName;
+        return;
+    }
+    loadUnit();
+}
+
+void SystemdUnitWatcher::loadUnit()
+{
+    // systemd only emits unit signals while at least one client is subscribed.
+    // A second Subscribe from the same connection fails harmlessly.
+    bus.asyncCall(QDBusMessage::createMethodCall(Service, ManagerPath, ManagerInterface, "Subscribe"));
+
+    // LoadUnit also works for units that are currently not loaded
+    QDBusMessage call = QDBusMessage::createMethodCall(Service, ManagerPath, ManagerInterface, "LoadUnit");
+    call << unitName;
+
+    const int callGeneration = generation;
+    QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(bus.asyncCall(call), this);
+    connect(callWatcher, &QDBusPendingCallWatcher::finished, this, [this, callGeneration](QDBusPendingCallWatcher *finishedCall) {
+        QDBusPendingReply<QDBusObjectPath> reply = *finishedCall;
+        finishedCall->deleteLater();
+
+        if (callGeneration != generation)
+        {
+            return;
+        }
+        if (reply.isError())
+        {
+            qDebug() << "Failed to load unit" << unitName << ":" << reply.error().message();
+            reset();
+            return;
+        }
+
+        // Subscribe before reading so no change can slip in between
+        unitPath = reply.value().path();
+        bus.connect(Service, unitPath, PropertiesInterface, "PropertiesChanged",
+                    this, SLOT(propertiesChanged(QDBusMessage)));
+        readActiveState();
+    });
+}
+
+void SystemdUnitWatcher::readActiveState()
+{
+    QDBusMessage get = QDBusMessage::createMethodCall(Service, unitPath, PropertiesInterface, "Get");
+    get << UnitInterface << QString("ActiveState");
+
+    const int callGeneration = generation;
+    QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(bus.asyncCall(get), this);
+    connect(callWatcher, &QDBusPendingCallWatcher::finished, this, [this, callGeneration](QDBusPendingCallWatcher *finishedCall) {
+        QDBusPendingReply<QDBusVariant> reply = *finishedCall;
+        finishedCall->deleteLater();
+
+        if (callGeneration != generation)
+        {
+            return;
+        }
+        if (reply.isError())
+        {
+            qDebug() << "Failed to read ActiveState of" << unitName << ":" << reply.error().message();
+            reset();
+            return;
+        }
+
+        // Only a state that has actually been read counts as watching
+        applyActiveState(reply.value().variant().toString());
+        setWatching(true);
+    });
+}
+
+void SystemdUnitWatcher::propertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() < 3 || arguments.at(0).toString() != UnitInterface)
+    {
+        return;
+    }
+
+    const QVariantMap changed = qdbus_cast<QVariantMap>(arguments.at(1));
+    auto it = changed.constFind("ActiveState");
+    if (it != changed.constEnd())
+    {
+        applyActiveState(it->toString());
+    }
+    else if (qdbus_cast<QStringList>(arguments.at(2)).contains("ActiveState"))
+    {
+        // Only invalidated, the new value has to be fetched
+        readActiveState();
+    }
+}
+
+void SystemdUnitWatcher::applyActiveState(const QString &newState)
+{
+    if (newState == state)
+    {
+        return;
+    }
+    state = newState;
+    emit activeStateChanged(state);
+}
+
+void SystemdUnitWatcher::reset()
+{
+    ++generation;
+
+    if (!unitPath.isEmpty())
+    {
+        bus.disconnect(Service, unitPath, PropertiesInterface, "PropertiesChanged",
+                       this, SLOT(propertiesChanged(QDBusMessage)));
+        unitPath.clear();
+    }
+    state.clear();
+    setWatching(false);
+}
+
+void SystemdUnitWatcher::setWatching(bool isWatching)
+{
+    if (watching == isWatching)
+    {
+        return;
+    }
+    watching = isWatching;
+    emit watchingChanged(watching);
+}
@@ -0,0 +1,60 @@
+#ifndef SYSTEMDUNITWATCHER_H
+#define SYSTEMDUNITWATCHER_H
+
+#include <QObject>
+#include <QDBusConnection>
+#include <QString>
+
+class QDBusMessage;
+class QDBusServiceWatcher;
+
+// Follows the ActiveState of a single systemd unit through the unit's
+// PropertiesChanged signal instead of running systemctl on a timer.
+// systemd's bus name is followed as well, so a systemd that shows up late or
+// restarts is picked up again.
+class SystemdUnitWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    SystemdUnitWatcher(const QString &unitName, const QDBusConnection &bus, QObject *parent = nullptr);
+
+    // Returns false when there is no bus. Whether the unit can be followed is found
+    // out without blocking, watchingChanged() reports the answer and every later change.
+    bool start();
+
+    // True once the unit's state has been read, false again after any error
+    bool isWatching() const;
+
+    // Last reported ActiveState ("active", "inactive", "activating", ...), empty until known
+    QString activeState() const;
+    bool isActive() const;
+
+signals:
+    void watchingChanged(bool watching);
+    void activeStateChanged(const QString &state);
+
+private slots:
+    void propertiesChanged(const QDBusMessage &message);
+    void serviceOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner);
+
+private:
+    void loadUnit();
+    void readActiveState();
+    void applyActiveState(const QString &newState);
+
+    // Stop following the unit, e.g. after an error or when systemd went away
+    void reset();
+    void setWatching(bool isWatching);
+
+    QString unitName;
+    QString unitPath;
+    QDBusConnection bus;
+    QDBusServiceWatcher *serviceWatcher;
+    QString owner;   // unique name of the running systemd, empty when it is gone
+    int generation;  // bumped on every owner change and error, older replies are dropped
+    bool watching;
+    QString state;
+};
+
+#endif // SYSTEMDUNITWATCHER_H
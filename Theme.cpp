@@ -0,0 +1,88 @@
+#include "Theme.h"
+#include "Trace.h"
+
+#include <QApplication>
+#include <QStyle>
+#include <QVariant>
+#include <QWidget>
+
+namespace {
+
+const char *const RoleProperty = "role";
+const char *const SelectedProperty = "selected";
+
+// Colours: background rgba(23,27,46), panels and tiles rgba(27,33,52,200), option
+// panel rgba(5,10,30), selection rgba(58,94,171). Keep color() in step.
+const char *const Sheet =
+    "QLabel { background: transparent; color: white; }"
+
+    "QWidget#background { background-color: rgba(23,27,46,255); }"
+    "QWidget#weatherPanel { background-color: rgba(27,33,52,200); border-radius: 100; }"
+    "QWidget#optionPanel { background-color: rgba(5,10,30,255);"
+    " border-top-left-radius: 60px; border-top-right-radius: 60px; }"
+    "QWidget#debugOverlay { background-color: rgba(0,0,0,200); }"
+    "QWidget#idleOverlay { background-color: black; }"
+    "QListView#devicePage { background: transparent; border: none; }"
+
+    "QPushButton[role=\"area\"] { background-color: transparent; color: white; border-radius: 30px; }"
+    "QPushButton[role=\"area\"][selected=\"true\"] { background-color: rgba(58,94,171,255); }"
+
+    "QPushButton[role=\"toggle\"] { background-color: rgba(40,44,49,255); color: white;"
+    " border: none; border-radius: 5px; padding: 5px 15px; }"
+    "QPushButton[role=\"toggle\"]:checked { background-color: rgba(58,94,171,255); }";
+
+} // namespace
+
+QColor Theme::color(Color role)
+{
+    switch (role)
+    {
+    case Color::Background:
+        return QColor(23, 27, 46);
+    case Color::Tile:
+        return QColor(27, 33, 52, 200);
+    case Color::Selection:
+        return QColor(58, 94, 171);
+    case Color::Text:
+        break;
+    }
+    return QColor(Qt::white);
+}
+
+void Theme::apply(QApplication *app)
+{
+    TRACE_SCOPE("Theme::apply");
+
+    app->setStyleSheet(styleSheet());
+}
+
+const QString &Theme::styleSheet()
+{
+    static const QString sheet = QString::fromLatin1(Sheet);
+    return sheet;
+}
+
+void Theme::setRole(QWidget *widget, const char *role)
+{
+    widget->setProperty(RoleProperty, QString::fromLatin1(role));
+}
+
+void Theme::setSelected(QWidget *widget, bool selected)
+{
+    if (!widget || isSelected(widget) == selected)
+    {
+        return;
+    }
+    widget->setProperty(SelectedProperty, selected);
+
+    // Property selectors are only matched at polish time
+    QStyle *style = widget->style();
+    style->unpolish(widget);
+    style->polish(widget);
+    widget->update();
+}
+
+bool Theme::isSelected(const QWidget *widget)
+{
+    return widget->property(SelectedProperty).toBool();
+}
@@ -0,0 +1,40 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QColor>
+
+class QApplication;
+class QString;
+class QWidget;
+
+// One application style sheet for the whole panel. Widgets pick their rules up
+// through an object name or a "role" property, and selection is the boolean
+// "selected" property, so changing it only re-polishes the widget against the
+// sheet that was parsed at startup instead of parsing a new one.
+namespace Theme
+{
+    // Colours for widgets that paint themselves, the same ones the sheet uses
+    enum class Color
+    {
+        Background,
+        Tile,
+        Selection,
+        Text
+    };
+
+    QColor color(Color role);
+
+    // Install the style sheet, call once before the first widget is created
+    void apply(QApplication *app);
+
+    const QString &styleSheet();
+
+    // Roles with rules in the sheet: "area" and "toggle"
+    void setRole(QWidget *widget, const char *role);
+
+    // Re-polish and repaint the widget only when the state changes
+    void setSelected(QWidget *widget, bool selected);
+    bool isSelected(const QWidget *widget);
+}
+
+#endif // THEME_H
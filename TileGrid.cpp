@@ -0,0 +1,245 @@
+#include "TileGrid.h"
+#include "Theme.h"
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+
+namespace {
+
+const int Margin = 10;
+const qreal CornerRadius = 5;
+
+} // namespace
+
+TileGrid::TileGrid(QWidget *parent)
+    : QWidget(parent),
+    cellSize(170),
+    cellSpacing(10),
+    rows(0),
+    columns(0),
+    pressedIndex(-1)
+{
+    // One font for every tile
+    QFont tileFont;
+    tileFont.setPointSize(16);
+    tileFont.setFamily("Arial");
+    tileFont.setBold(true);
+    setFont(tileFont);
+}
+
+void TileGrid::setCellSize(int size, int spacing)
+{
+    cellSize = size;
+    cellSpacing = spacing;
+    relayout();
+}
+
+void TileGrid::addTile(int id, const QString &text, int row, int column, int span, int group)
+{
+    Tile tile;
+    tile.id = id;
+    tile.row = qint16(row);
+    tile.column = qint16(column);
+    tile.span = qint16(span);
+    tile.group = qint16(group);
+    tile.selected = false;
+    tile.text = text;
+    tiles.append(tile);
+
+    rows = qMax(rows, row + span);
+    columns = qMax(columns, column + span);
+    relayout();
+}
+
+void TileGrid::clear()
+{
+    tiles.clear();
+    rows = 0;
+    columns = 0;
+    pressedIndex = -1;
+    updateGeometry();
+    update();
+}
+
+int TileGrid::count() const
+{
+    return tiles.size();
+}
+
+void TileGrid::select(int id)
+{
+    int index = indexOf(id);
+    if (index < 0)
+    {
+        return;
+    }
+
+    Tile &target = tiles[index];
+    for (Tile &tile : tiles)
+    {
+        if (tile.group == target.group && tile.selected && tile.id != id)
+        {
+            tile.selected = false;
+            update(tile.rect);
+        }
+    }
+    if (!target.selected)
+    {
+        target.selected = true;
+        update(target.rect);
+    }
+}
+
+void TileGrid::clearSelection(int group)
+{
+    for (Tile &tile : tiles)
+    {
+        if (tile.group == group && tile.selected)
+        {
+            tile.selected = false;
+            update(tile.rect);
+        }
+    }
+}
+
+int TileGrid::selected(int group) const
+{
+    for (const Tile &tile : tiles)
+    {
+        if (tile.group == group && tile.selected)
+        {
+            return tile.id;
+        }
+    }
+    return -1;
+}
+
+int TileGrid::tileAt(const QPoint &pos) const
+{
+    for (const Tile &tile : tiles)
+    {
+        if (tile.rect.contains(pos))
+        {
+            return tile.id;
+        }
+    }
+    return -1;
+}
+
+QRect TileGrid::tileRect(int id) const
+{
+    int index = indexOf(id);
+    return index < 0 ? QRect() : tiles.at(index).rect;
+}
+
+int TileGrid::findTile(const QString &text) const
+{
+    for (const Tile &tile : tiles)
+    {
+        if (tile.text == text)
+        {
+            return tile.id;
+        }
+    }
+    return -1;
+}
+
+QSize TileGrid::sizeHint() const
+{
+    const int width = columns * cellSize + qMax(0, columns - 1) * cellSpacing;
+    const int height = rows * cellSize + qMax(0, rows - 1) * cellSpacing;
+    return QSize(width + 2 * Margin, height + 2 * Margin);
+}
+
+void TileGrid::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    const QColor tileColor = Theme::color(Theme::Color::Tile);
+    const QColor selectionColor = Theme::color(Theme::Color::Selection);
+    const QColor textColor = Theme::color(Theme::Color::Text);
+
+    // Only the tiles in the damaged region are drawn
+    for (const Tile &tile : tiles)
+    {
+        if (!event->rect().intersects(tile.rect))
+        {
+            continue;
+        }
+
+        painter.setBrush(tile.selected ? selectionColor : tileColor);
+        painter.drawRoundedRect(tile.rect, CornerRadius, CornerRadius);
+
+        painter.setPen(textColor);
+        painter.drawText(tile.rect, Qt::AlignCenter | Qt::TextWordWrap, tile.text);
+        painter.setPen(Qt::NoPen);
+    }
+}
+
+void TileGrid::mousePressEvent(QMouseEvent *event)
+{
+    pressedIndex = -1;
+    if (event->button() == Qt::LeftButton)
+    {
+        pressedIndex = indexOf(tileAt(event->position().toPoint()));
+    }
+
+    // Presses outside the tiles go on to the panel behind
+    if (pressedIndex < 0)
+    {
+        event->ignore();
+    }
+}
+
+void TileGrid::mouseReleaseEvent(QMouseEvent *event)
+{
+    const int index = pressedIndex;
+    pressedIndex = -1;
+
+    // A click is a press and release on the same tile, like a button
+    if (event->button() == Qt::LeftButton && index >= 0 && index < tiles.size() &&
+        tiles.at(index).rect.contains(event->position().toPoint()))
+    {
+        emit tileClicked(tiles.at(index).id);
+        return;
+    }
+    event->ignore();
+}
+
+void TileGrid::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    relayout();
+}
+
+int TileGrid::indexOf(int id) const
+{
+    for (int i = 0; i < tiles.size(); ++i)
+    {
+        if (tiles.at(i).id == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TileGrid::relayout()
+{
+    const QSize content = sizeHint();
+    const int left = Margin;
+    const int top = qMax(0, (height() - content.height()) / 2) + Margin;
+    const int step = cellSize + cellSpacing;
+
+    for (Tile &tile : tiles)
+    {
+        const int extent = tile.span * cellSize + (tile.span - 1) * cellSpacing;
+        tile.rect = QRect(left + tile.column * step, top + tile.row * step, extent, extent);
+    }
+
+    updateGeometry();
+    update();
+}
@@ -0,0 +1,77 @@
+#ifndef TILEGRID_H
+#define TILEGRID_H
+
+#include <QWidget>
+#include <QList>
+#include <QRect>
+#include <QString>
+
+// Every tile of the item panel in one widget. Tiles are plain records in a flat
+// list, placed on a grid of square cells; the widget paints and hit-tests them
+// itself, so a tile costs no child widget, layout item, font or style sheet.
+class TileGrid : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TileGrid(QWidget *parent = nullptr);
+
+    // Cell edge and the gap between cells in pixels, a tile spanning two cells
+    // is 2 * size + spacing wide
+    void setCellSize(int size, int spacing);
+
+    // Add a tile over span x span cells. Selection is exclusive within a group.
+    void addTile(int id, const QString &text, int row, int column, int span = 1, int group = 0);
+    void clear();
+    int count() const;
+
+    // Select a tile and deselect the rest of its group, only the two tiles are repainted
+    void select(int id);
+    void clearSelection(int group);
+
+    // Selected tile of a group, -1 when there is none
+    int selected(int group) const;
+
+    // Tile under a point in widget coordinates, -1 when there is none
+    int tileAt(const QPoint &pos) const;
+    QRect tileRect(int id) const;
+    int findTile(const QString &text) const;
+
+    QSize sizeHint() const override;
+
+signals:
+    void tileClicked(int id);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    struct Tile
+    {
+        int id;
+        qint16 row;
+        qint16 column;
+        qint16 span;
+        qint16 group;
+        bool selected;
+        QRect rect; // pixels, kept by relayout()
+        QString text;
+    };
+
+    int indexOf(int id) const;
+
+    // Place the tiles left aligned and vertically centred
+    void relayout();
+
+    QList<Tile> tiles;
+    int cellSize;
+    int cellSpacing;
+    int rows;
+    int columns;
+    int pressedIndex;
+};
+
+#endif // TILEGRID_H
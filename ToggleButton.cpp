@@ -1,4 +1,5 @@
 #include "ToggleButton.h"
+#include "Theme.h"
 
 ToggleButton::ToggleButton(QWidget *parent)
     : QWidget(parent),
@@ -12,15 +13,9 @@ ToggleButton::ToggleButton(QWidget *parent)
     labelFont.setBold(true);
 
     toggleLabel->setFont(labelFont);
-    toggleLabel->setStyleSheet("background-color: transparent; color: white;");
 
     toggleButton->setCheckable(true);
-    toggleButton->setStyleSheet("QPushButton { background-color: rgba(40,44,49,255); "
-                              "color: white; "
-                              "border: none; "
-                              "border-radius: 5px; "
-                              "padding: 5px 15px; } "
-                              "QPushButton:checked { background-color: rgba(58,94,171,255); }");
+    Theme::setRole(toggleButton, "toggle");
 
     layout->addWidget(toggleLabel);
     layout->addWidget(toggleButton);
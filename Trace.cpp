@@ -0,0 +1,178 @@
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    char phase;     // 'X' complete span, 'i' instant
+    int thread;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+// Started while static initialisers run, before main
+const QElapsedTimer processClock = []() {
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}();
+
+std::atomic<bool> enabled{false};
+std::atomic<int> nextThread{1};
+
+QMutex eventsMutex;
+QList<Event> events;
+
+// Small stable ids, trace viewers show one row per thread
+int threadId()
+{
+    thread_local int id = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void record(const Event &event)
+{
+    QMutexLocker locker(&eventsMutex);
+    events.append(event);
+}
+
+// Names are string literals, only quotes and backslashes need escaping
+QByteArray escaped(const char *name)
+{
+    QByteArray text(name);
+    text.replace('\\', "\\\\");
+    text.replace('"', "\\\"");
+    return text;
+}
+
+} // namespace
+
+Trace::Span::Span(const char *name)
+    : name(name),
+    startNs(enabled.load(std::memory_order_relaxed) ? processClock.nsecsElapsed() : -1)
+{
+}
+
+// Destructor
+Trace::Span::~Span()
+{
+    if (startNs < 0)
+    {
+        return;
+    }
+
+    Event event;
+    event.name = name;
+    event.phase = 'X';
+    event.thread = threadId();
+    event.startNs = startNs;
+    event.durationNs = processClock.nsecsElapsed() - startNs;
+    record(event);
+}
+
+void Trace::startFromEnvironment()
+{
+    if (qEnvironmentVariableIsEmpty("HOMESCREEN_TRACE"))
+    {
+        return;
+    }
+
+    // The thread that starts tracing is the GUI thread, it gets the first id
+    threadId();
+    {
+        QMutexLocker locker(&eventsMutex);
+        events.reserve(4096);
+    }
+    enabled.store(true);
+}
+
+bool Trace::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+qint64 Trace::elapsedNs()
+{
+    return processClock.nsecsElapsed();
+}
+
+void Trace::instant(const char *name)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    Event event;
+    event.name = name;
+    event.phase = 'i';
+    event.thread = threadId();
+    event.startNs = processClock.nsecsElapsed();
+    event.durationNs = 0;
+    record(event);
+}
+
+bool Trace::exportTo(const QString &path)
+{
+    if (!isEnabled())
+    {
+        return false;
+    }
+
+    QString target = path.isEmpty() ? qEnvironmentVariable("HOMESCREEN_TRACE") : path;
+
+    QList<Event> recorded;
+    {
+        QMutexLocker locker(&eventsMutex);
+        recorded = events;
+    }
+
+    // Timestamps are in microseconds, fractions keep the nanoseconds
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+            ",\"tid\":1,\"args\":{\"name\":\"GUI\"}}";
+    for (const Event &event : recorded)
+    {
+        json += ",\n{\"name\":\"" + escaped(event.name) + "\",\"ph\":\"" + event.phase + '"';
+        json += ",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(event.thread);
+        json += ",\"ts\":" + QByteArray::number(event.startNs / 1000.0, 'f', 3);
+        if (event.phase == 'X')
+        {
+            json += ",\"dur\":" + QByteArray::number(event.durationNs / 1000.0, 'f', 3);
+        }
+        else
+        {
+            json += ",\"s\":\"g\"";
+        }
+        json += '}';
+    }
+    json += "\n]}\n";
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Failed to write trace to" << target << ":" << file.errorString();
+        return false;
+    }
+    file.write(json);
+    if (!file.commit())
+    {
+        return false;
+    }
+    qDebug() << "Wrote" << recorded.size() << "trace events to" << target;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Scoped spans written as Chrome trace events, for chrome://tracing or Perfetto.
+// Recording is off unless HOMESCREEN_TRACE names the output file; a disabled
+// span costs one relaxed atomic load. Spans may be opened on any thread.
+class Trace
+{
+public:
+    class Span
+    {
+    public:
+        explicit Span(const char *name);
+        ~Span();
+
+    private:
+        const char *name;  // must outlive the trace, string literals only
+        qint64 startNs;    // -1 when recording was off at construction
+    };
+
+    // Enable recording when HOMESCREEN_TRACE is set, safe to call before QApplication
+    static void startFromEnvironment();
+    static bool isEnabled();
+
+    // Time since the process started running static initialisers
+    static qint64 elapsedNs();
+
+    // A point in time, such as the first frame
+    static void instant(const char *name);
+
+    // Write every recorded event as trace-event JSON, the default path is HOMESCREEN_TRACE
+    static bool exportTo(const QString &path = QString());
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing block
+#define TRACE_SCOPE(name) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#endif // TRACE_H
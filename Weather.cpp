@@ -1,13 +1,185 @@
 #include "Weather.h"
+#include "CommandStats.h"
+#include "StallWatchdog.h"
+#include "Trace.h"
+#include "WeatherCache.h"
 
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
 #include <QStringList>
 #include <QDebug>
 
+namespace {
+
+// Current conditions for HOMESCREEN_WEATHER_LATITUDE and HOMESCREEN_WEATHER_LONGITUDE
+const char *const EndpointTemplate =
+    "https://api.open-meteo.com/v1/forecast?latitude=%1&longitude=%2"
+    "&current=temperature_2m,apparent_temperature,is_day,precipitation,snowfall,"
+    "cloud_cover,wind_speed_10m,wind_direction_10m&wind_speed_unit=ms";
+
+// Two missed refreshes and the shown values are marked as old
+const qint64 StaleAfterMs = 20 * 60 * 1000;
+
+inline void skipWhitespace(const char *&cursor, const char *end)
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t'))
+    {
+        ++cursor;
+    }
+}
+
+// Cursor on the opening quote, leaves it after the closing one. Escapes are
+// skipped but not decoded, the keys we look for never contain any.
+bool readString(const char *&cursor, const char *end, QByteArrayView *text)
+{
+    if (cursor == end || *cursor != '"')
+    {
+        return false;
+    }
+    const char *start = ++cursor;
+    while (cursor < end && *cursor != '"')
+    {
+        cursor += (*cursor == '\\') ? 2 : 1;
+    }
+    if (cursor >= end)
+    {
+        return false;
+    }
+    *text = QByteArrayView(start, cursor - start);
+    ++cursor;
+    return true;
+}
+
+// Skip any value: strings, numbers, literals and whole nested objects or arrays.
+// Leaves the cursor on the character after the value.
+bool skipValue(const char *&cursor, const char *end)
+{
+    int depth = 0;
+    while (cursor < end)
+    {
+        const char c = *cursor;
+        if (c == '"')
+        {
+            QByteArrayView ignored;
+            if (!readString(cursor, end, &ignored))
+            {
+                return false;
+            }
+            if (depth == 0)
+            {
+                return true;
+            }
+        }
+        else if (c == '{' || c == '[')
+        {
+            ++depth;
+            ++cursor;
+        }
+        else if (c == '}' || c == ']')
+        {
+            // The end of the enclosing object ends a scalar
+            if (depth == 0)
+            {
+                return true;
+            }
+            ++cursor;
+            if (--depth == 0)
+            {
+                return true;
+            }
+        }
+        else if (c == ',' && depth == 0)
+        {
+            return true;
+        }
+        else
+        {
+            ++cursor;
+        }
+    }
+    return false;
+}
+
+// Numbers as JSON and the script print them, returns false when there is none at the cursor
+bool readNumber(const char *&cursor, const char *end, double *value)
+{
+    const char *start = cursor;
+    while (cursor < end && (*cursor == '-' || *cursor == '+' || *cursor == '.' ||
+                            *cursor == 'e' || *cursor == 'E' || (*cursor >= '0' && *cursor <= '9')))
+    {
+        ++cursor;
+    }
+
+    // fromRawData wraps the bytes without copying them
+    bool ok = false;
+    *value = QByteArray::fromRawData(start, cursor - start).toDouble(&ok);
+    return ok;
+}
+
+// Cursor on the opening brace of the "current" object
+bool readCurrent(const char *&cursor, const char *end, WeatherSnapshot *snapshot)
+{
+    ++cursor;
+    for (;;)
+    {
+        skipWhitespace(cursor, end);
+        if (cursor < end && *cursor == '}')
+        {
+            ++cursor;
+            return true;
+        }
+
+        QByteArrayView key;
+        if (!readString(cursor, end, &key))
+        {
+            return false;
+        }
+        skipWhitespace(cursor, end);
+        if (cursor == end || *cursor != ':')
+        {
+            return false;
+        }
+        ++cursor;
+        skipWhitespace(cursor, end);
+
+        double value = 0;
+        if (cursor < end && (*cursor == '-' || (*cursor >= '0' && *cursor <= '9')))
+        {
+            if (readNumber(cursor, end, &value))
+            {
+                // Names the panel does not use are ignored
+                snapshot->set(key, value);
+            }
+        }
+        else if (!skipValue(cursor, end))
+        {
+            return false;
+        }
+
+        skipWhitespace(cursor, end);
+        if (cursor < end && *cursor == ',')
+        {
+            ++cursor;
+        }
+    }
+}
+
+} // namespace
+
 // Constructor
 Weather::Weather(QObject *parent)
     : QObject(parent),
+    updatedAt(0),
+    network(new QNetworkAccessManager(this)),
+    reply(nullptr),
+    pythonPath(qEnvironmentVariable("HOMESCREEN_WEATHER_PYTHON", "python3")),
+    scriptPath(qEnvironmentVariable("HOMESCREEN_WEATHER_SCRIPT")),
     process(new QProcess(this))
 {
+    TRACE_SCOPE("Weather::Weather");
+
     // Connect 'finished' signal to 'processFinished' slot
     connect(process, SIGNAL(finished(int, QProcess::ExitStatus)),
             this, SLOT(processFinished(int, QProcess::ExitStatus)));
@@ -21,113 +193,309 @@ Weather::Weather(QObject *parent)
             qDebug() << "Weather script stderr:" <<errData;
         }
     });
+
+    // A script that never starts does not emit finished
+    connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error)
+    {
+        if (error == QProcess::FailedToStart)
+        {
+            CommandStats::instance()->record(CommandStats::commandKey(process->program(), process->arguments()),
+                                             runTimer.nsecsElapsed() / 1000, -1, 0);
+            emit fetchFailed();
+        }
+    });
+
+    // Showing the weather of some default place would look right and be wrong
+    if (endpoint().isEmpty())
+    {
+        qWarning() << "No weather location configured, set HOMESCREEN_WEATHER_LATITUDE and"
+                   << "HOMESCREEN_WEATHER_LONGITUDE (or HOMESCREEN_WEATHER_URL)."
+                   << (scriptPath.isEmpty() ? "The weather panel stays empty." : "Using the weather script only.");
+    }
+
+    // Start from the last good snapshot so the first frame already has weather in it
+    if (WeatherCache::load(&values, &updatedAt))
+    {
+        qDebug() << "Weather loaded from cache, fetched" << lastUpdated().toString(Qt::ISODate);
+    }
 }
 
 // Destructor
 Weather::~Weather()
 {
-    if (process)
+    // Aborting emits finished synchronously, and our owner is already half destroyed
+    if (reply)
     {
-        process->deleteLater();
+        reply->disconnect(this);
+        reply->abort();
+        delete reply;
+    }
+
+    // Nothing may report back either way, the script's result is no longer wanted
+    process->disconnect(this);
+    if (process->state() != QProcess::NotRunning)
+    {
+        process->kill();
+        process->waitForFinished(1000);
     }
 }
 
+QUrl Weather::endpoint()
+{
+    QString url = qEnvironmentVariable("HOMESCREEN_WEATHER_URL");
+    if (!url.isEmpty())
+    {
+        return QUrl(url);
+    }
+
+    bool latitudeOk = false;
+    bool longitudeOk = false;
+    const double latitude = qEnvironmentVariable("HOMESCREEN_WEATHER_LATITUDE").toDouble(&latitudeOk);
+    const double longitude = qEnvironmentVariable("HOMESCREEN_WEATHER_LONGITUDE").toDouble(&longitudeOk);
+    if (!latitudeOk || !longitudeOk || qAbs(latitude) > 90 || qAbs(longitude) > 180)
+    {
+        return QUrl();
+    }
+    return QUrl(QString(EndpointTemplate).arg(latitude, 0, 'f', 2).arg(longitude, 0, 'f', 2));
+}
+
 void Weather::updateWeatherData()
 {
-    // Virtual environment path
-    QString pythonPath = "";
+    TRACE_SCOPE("Weather::updateWeatherData");
+
+    // The previous request is still on its way
+    if (reply)
+    {
+        return;
+    }
+
+    // Without a location there is nothing to fetch, only the script can help
+    const QUrl url = endpoint();
+    if (url.isEmpty())
+    {
+        if (!startScript())
+        {
+            emit fetchFailed();
+        }
+        return;
+    }
+
+    QNetworkRequest request(url);
+    request.setTransferTimeout(10000);
+    reply = network->get(request);
+    connect(reply, &QNetworkReply::finished, this, &Weather::replyFinished);
+}
+
+void Weather::replyFinished()
+{
+    StallWatchdog::Scope stallScope("Weather::replyFinished");
+    TRACE_SCOPE("Weather::replyFinished");
+
+    QNetworkReply *finished = reply;
+    reply = nullptr;
+    finished->deleteLater();
+
+    if (finished->error() != QNetworkReply::NoError)
+    {
+        qDebug() << "Weather request failed:" << finished->errorString();
+        if (!startScript())
+        {
+            emit fetchFailed();
+        }
+        return;
+    }
+
+    WeatherSnapshot parsed;
+    if (!parseOpenMeteo(finished->readAll(), &parsed))
+    {
+        qDebug() << "Weather response has no current conditions";
+        if (!startScript())
+        {
+            emit fetchFailed();
+        }
+        return;
+    }
+
+    apply(parsed);
+}
+
+void Weather::apply(const WeatherSnapshot &snapshot)
+{
+    values = snapshot;
+    updatedAt = QDateTime::currentMSecsSinceEpoch();
+    WeatherCache::save(values, updatedAt);
 
-    // API script path
-    QString scriptPath = "";
+    emit weatherDataUpdated();
+}
+
+bool Weather::hasData() const
+{
+    return updatedAt > 0;
+}
+
+bool Weather::isStale() const
+{
+    return !hasData() || QDateTime::currentMSecsSinceEpoch() - updatedAt > StaleAfterMs;
+}
+
+QDateTime Weather::lastUpdated() const
+{
+    return hasData() ? QDateTime::fromMSecsSinceEpoch(updatedAt) : QDateTime();
+}
+
+bool Weather::startScript()
+{
+    if (scriptPath.isEmpty())
+    {
+        return false;
+    }
+    if (process->state() != QProcess::NotRunning)
+    {
+        return true;
+    }
 
     // Start process
+    runTimer.start();
     process->start(pythonPath, QStringList() << scriptPath);
+    return true;
 }
 
 void Weather::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    StallWatchdog::Scope stallScope("Weather::processFinished");
+    TRACE_SCOPE("Weather::processFinished");
+
     qDebug() << "Process finished with exit code:" << exitCode << "and exit status:" << exitStatus;
 
-    QString output = process->readAllStandardOutput();
-    parseOutput(output);
+    QByteArray rawOutput = process->readAllStandardOutput();
+    CommandStats::instance()->record(CommandStats::commandKey(process->program(), process->arguments()),
+                                     runTimer.nsecsElapsed() / 1000,
+                                     exitStatus == QProcess::NormalExit ? exitCode : -1,
+                                     rawOutput.size());
 
-    emit weatherDataUpdated();
+    // A failed run keeps the values shown, they are only marked stale later
+    WeatherSnapshot parsed;
+    if (exitStatus != QProcess::NormalExit || exitCode != 0 || !parseOutput(rawOutput, &parsed))
+    {
+        emit fetchFailed();
+        return;
+    }
+    apply(parsed);
 }
 
-// Split output into lines and process each line
-void Weather::parseOutput(const QString &output)
+bool Weather::parseOpenMeteo(const QByteArray &json, WeatherSnapshot *snapshot)
 {
-    // Clear previous weather data
-    temperature.clear();
-    apparentTemperature.clear();
-    precipitation.clear();
-    cloudCover.clear();
-    isDay.clear();
-    windSpeed.clear();
-    windDirection.clear();
-    snowfall.clear();
+    const char *cursor = json.constData();
+    const char *end = cursor + json.size();
 
-    // Split into lines, ignoring empty lines
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    skipWhitespace(cursor, end);
+    if (cursor == end || *cursor != '{')
+    {
+        return false;
+    }
+    ++cursor;
 
-    // Iterate though each line
-    for (const QString &line : lines)
+    // Walk the top level keys once, everything but "current" is skipped unparsed
+    bool found = false;
+    for (;;)
     {
-        if (line.startsWith("Current temperature_2m")) {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) temperature = parts.last().trimmed();
+        skipWhitespace(cursor, end);
+        if (cursor == end || *cursor == '}')
+        {
+            return found;
         }
-        else if (line.startsWith("Current apparent_temperature"))
+
+        QByteArrayView key;
+        if (!readString(cursor, end, &key))
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) apparentTemperature = parts.last().trimmed();
+            return found;
         }
-        else if (line.startsWith("Current precipitation"))
+        skipWhitespace(cursor, end);
+        if (cursor == end || *cursor != ':')
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) precipitation = parts.last().trimmed();
+            return found;
         }
-        else if (line.startsWith("Current cloud_cover"))
+        ++cursor;
+        skipWhitespace(cursor, end);
+
+        if (key == QByteArrayView("current") && cursor < end && *cursor == '{')
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) cloudCover = parts.last().trimmed();
+            if (!readCurrent(cursor, end, snapshot))
+            {
+                return false;
+            }
+            found = true;
         }
-        else if (line.startsWith("Current is_day"))
+        else if (!skipValue(cursor, end))
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) isDay = parts.last().trimmed();
+            return found;
         }
-        else if (line.startsWith("Current wind_speed_10m"))
+
+        skipWhitespace(cursor, end);
+        if (cursor < end && *cursor == ',')
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) windSpeed = parts.last().trimmed();
+            ++cursor;
         }
-        else if (line.startsWith("Current wind_direction_10m"))
+    }
+}
+
+// Read "Current <name> <value>" lines in one pass over the bytes, nothing is copied
+bool Weather::parseOutput(QByteArrayView output, WeatherSnapshot *snapshot)
+{
+    static const QByteArrayView prefix("Current ");
+
+    *snapshot = WeatherSnapshot();
+
+    const char *cursor = output.data();
+    const char *end = cursor + output.size();
+    while (cursor < end)
+    {
+        const char *lineEnd = cursor;
+        while (lineEnd < end && *lineEnd != '\n')
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) windDirection = parts.last().trimmed();
+            ++lineEnd;
         }
-        else if (line.startsWith("Current snowfall"))
+
+        QByteArrayView line(cursor, lineEnd - cursor);
+        if (line.startsWith(prefix))
         {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3) snowfall = parts.last().trimmed();
+            // Name up to the next space, the value is the last word of the line
+            const char *nameStart = cursor + prefix.size();
+            const char *nameEnd = nameStart;
+            while (nameEnd < lineEnd && *nameEnd != ' ')
+            {
+                ++nameEnd;
+            }
+
+            const char *valueEnd = lineEnd;
+            while (valueEnd > nameEnd && (valueEnd[-1] == ' ' || valueEnd[-1] == '\r'))
+            {
+                --valueEnd;
+            }
+            const char *valueStart = valueEnd;
+            while (valueStart > nameEnd && valueStart[-1] != ' ')
+            {
+                --valueStart;
+            }
+
+            double value = 0;
+            if (valueStart > nameEnd && readNumber(valueStart, valueEnd, &value) && valueStart == valueEnd)
+            {
+                snapshot->set(QByteArrayView(nameStart, nameEnd - nameStart), value);
+            }
         }
+        cursor = lineEnd + 1;
     }
-    if (temperature.isEmpty()) qDebug() << "No temperature found in output.";
-    if (apparentTemperature.isEmpty()) qDebug() << "No apparent temperature found in output.";
-    if (precipitation.isEmpty()) qDebug() << "No precipitation found in output.";
-    if (cloudCover.isEmpty()) qDebug() << "No cloud cover found in output.";
-    if (isDay.isEmpty()) qDebug() << "No is_day found in output.";
-    if (windSpeed.isEmpty()) qDebug() << "No wind speed found in output.";
-    if (windDirection.isEmpty()) qDebug() << "No wind direction found in output.";
-    if (snowfall.isEmpty()) qDebug() << "No snowfall found in output.";
+
+    if (!(snapshot->fields & WeatherSnapshot::Temperature))
+    {
+        qDebug() << "No temperature found in output.";
+        return false;
+    }
+    return true;
 }
 
-QString Weather::getTemperature() const { return temperature; }
-QString Weather::getApparentTemperature() const { return apparentTemperature; }
-QString Weather::getPrecipitation() const { return precipitation; }
-QString Weather::getCloudCover() const { return cloudCover; }
-QString Weather::getIsDay() const { return isDay; }
-QString Weather::getWindSpeed() const { return windSpeed; }
-QString Weather::getWindDirection() const { return windDirection; }
-QString Weather::getSnowfall() const { return snowfall; }
+const WeatherSnapshot &Weather::snapshot() const
+{
+    return values;
+}
@@ -3,7 +3,16 @@
 
 #include <QObject>
 #include <QString>
+#include <QByteArray>
+#include <QUrl>
+#include <QDateTime>
 #include <QProcess>
+#include <QElapsedTimer>
+
+#include "WeatherSnapshot.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
 
 class Weather : public QObject
 {
@@ -16,38 +25,57 @@ public:
     // Initiate weather data update
     void updateWeatherData();
 
-    // Getters for parsed weather data
-    QString getTemperature() const;
-    QString getApparentTemperature() const;
-    QString getPrecipitation() const;
-    QString getCloudCover() const;
-    QString getIsDay() const;
-    QString getWindSpeed() const;
-    QString getWindDirection() const;
-    QString getSnowfall() const;
+    // Last good weather data, restored from the cache at startup
+    const WeatherSnapshot &snapshot() const;
+    bool hasData() const;
+
+    // The snapshot is from an earlier session or updates have been failing
+    bool isStale() const;
+    QDateTime lastUpdated() const;
+
+    // Parse output from the weather script, returns false when it has no temperature
+    static bool parseOutput(QByteArrayView output, WeatherSnapshot *snapshot);
+
+    // Pull the "current" object of an Open-Meteo forecast response into a snapshot,
+    // returns false when the response has no current conditions
+    static bool parseOpenMeteo(const QByteArray &json, WeatherSnapshot *snapshot);
+
+    // Forecast URL for HOMESCREEN_WEATHER_LATITUDE and HOMESCREEN_WEATHER_LONGITUDE,
+    // HOMESCREEN_WEATHER_URL replaces it entirely. Empty when no location is set.
+    static QUrl endpoint();
 
 signals:
     // Emit signal when weather data is successfully updated
     void weatherDataUpdated();
 
+    // Emitted when neither the fetch nor the script produced new data, the old snapshot is kept
+    void fetchFailed();
+
 private slots:
+    // Handle the Open-Meteo reply
+    void replyFinished();
+
     // Handle QProcess finishing
     void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
 private:
-    // Parse output from weather API
-    void parseOutput(const QString &output);
-
-    QString temperature;
-    QString apparentTemperature;
-    QString precipitation;
-    QString cloudCover;
-    QString isDay;
-    QString windSpeed;
-    QString windDirection;
-    QString snowfall;
+    // Run the Python script, only used when the native fetch fails
+    bool startScript();
+
+    // Show and cache a freshly fetched snapshot
+    void apply(const WeatherSnapshot &snapshot);
+
+    WeatherSnapshot values;
+    qint64 updatedAt; // ms since the epoch, 0 before the first snapshot
+
+    QNetworkAccessManager *network;
+    QNetworkReply *reply;
 
+    // Optional fallback, set HOMESCREEN_WEATHER_PYTHON and HOMESCREEN_WEATHER_SCRIPT
+    QString pythonPath;
+    QString scriptPath;
     QProcess *process;
+    QElapsedTimer runTimer;
 };
 
 #endif // WEATHER_H
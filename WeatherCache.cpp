@@ -0,0 +1,91 @@
+#include "WeatherCache.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+// The file is this struct byte for byte, so reading it is one mmap and one copy
+struct Record
+{
+    char magic[4];
+    quint32 version;
+    qint64 fetchedAt;
+    WeatherSnapshot snapshot;
+};
+
+const char Magic[4] = {'H', 'S', 'W', 'C'};
+
+// Bump whenever WeatherSnapshot's layout changes, older files are then ignored
+const quint32 Version = 1;
+
+static_assert(std::is_trivially_copyable<WeatherSnapshot>::value, "The snapshot is stored as raw bytes");
+
+} // namespace
+
+QString WeatherCache::defaultPath()
+{
+    QString path = qEnvironmentVariable("HOMESCREEN_WEATHER_CACHE");
+    if (path.isEmpty())
+    {
+        path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/weather.bin";
+    }
+    return path;
+}
+
+bool WeatherCache::load(WeatherSnapshot *snapshot, qint64 *fetchedAt, const QString &path)
+{
+    TRACE_SCOPE("WeatherCache::load");
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != qint64(sizeof(Record)))
+    {
+        return false;
+    }
+
+    uchar *mapped = file.map(0, sizeof(Record));
+    if (!mapped)
+    {
+        return false;
+    }
+
+    Record record;
+    std::memcpy(&record, mapped, sizeof(Record));
+    file.unmap(mapped);
+
+    if (std::memcmp(record.magic, Magic, sizeof(Magic)) != 0 || record.version != Version)
+    {
+        return false;
+    }
+
+    *snapshot = record.snapshot;
+    *fetchedAt = record.fetchedAt;
+    return true;
+}
+
+bool WeatherCache::save(const WeatherSnapshot &snapshot, qint64 fetchedAt, const QString &path)
+{
+    Record record;
+    std::memset(&record, 0, sizeof(Record));
+    std::memcpy(record.magic, Magic, sizeof(Magic));
+    record.version = Version;
+    record.fetchedAt = fetchedAt;
+    record.snapshot = snapshot;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Failed to write weather cache" << path << ":" << file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&record), sizeof(Record));
+    return file.commit();
+}
@@ -0,0 +1,21 @@
+#ifndef WEATHERCACHE_H
+#define WEATHERCACHE_H
+
+#include <QString>
+
+#include "WeatherSnapshot.h"
+
+namespace WeatherCache
+{
+// weather.bin in the cache directory, or HOMESCREEN_WEATHER_CACHE
+QString defaultPath();
+
+// Map the cache file and copy out the last good snapshot and when it was fetched
+// (ms since the epoch). Returns false when there is no valid cache.
+bool load(WeatherSnapshot *snapshot, qint64 *fetchedAt, const QString &path = defaultPath());
+
+// Replace the cache file atomically
+bool save(const WeatherSnapshot &snapshot, qint64 fetchedAt, const QString &path = defaultPath());
+}
+
+#endif // WEATHERCACHE_H
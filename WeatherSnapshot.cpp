@@ -0,0 +1,96 @@
+#include "WeatherSnapshot.h"
+
+#include <iterator>
+
+namespace {
+
+struct FieldSetter
+{
+    const char *name;
+    void (*set)(WeatherSnapshot &snapshot, double value);
+    WeatherSnapshot::Field field;
+};
+
+const FieldSetter setters[] = {
+    {"temperature_2m", [](WeatherSnapshot &s, double v) { s.temperature = float(v); }, WeatherSnapshot::Temperature},
+    {"apparent_temperature", [](WeatherSnapshot &s, double v) { s.apparentTemperature = float(v); }, WeatherSnapshot::ApparentTemperature},
+    {"precipitation", [](WeatherSnapshot &s, double v) { s.precipitation = float(v); }, WeatherSnapshot::Precipitation},
+    {"snowfall", [](WeatherSnapshot &s, double v) { s.snowfall = float(v); }, WeatherSnapshot::Snowfall},
+    {"cloud_cover", [](WeatherSnapshot &s, double v) { s.cloudCover = quint8(qBound(0.0, v, 100.0)); }, WeatherSnapshot::CloudCover},
+    {"is_day", [](WeatherSnapshot &s, double v) { s.isDay = (v == 1.0); }, WeatherSnapshot::IsDay},
+    {"wind_speed_10m", [](WeatherSnapshot &s, double v) { s.windSpeed = float(v); }, WeatherSnapshot::WindSpeed},
+    {"wind_direction_10m", [](WeatherSnapshot &s, double v) { s.windDirection = quint16(qBound(0.0, v, 360.0)); }, WeatherSnapshot::WindDirection}
+};
+
+// Indexed by WeatherCondition
+const char *const iconFiles[] = {
+    "weather-clear-symbolic.symbolic.png",
+    "weather-clear-night-symbolic.symbolic.png",
+    "weather-few-clouds-symbolic.symbolic.png",
+    "weather-few-clouds-night-symbolic.symbolic.png",
+    "weather-overcast-symbolic.symbolic.png",
+    "weather-showers-symbolic.symbolic.png",
+    "weather-snow-symbolic.symbolic.png",
+    "weather-windy-symbolic.symbolic.png",
+    "weather-windy-symbolic.symbolic.png",
+    "weather-severe-alert-symbolic.symbolic.png"
+};
+static_assert(std::size(iconFiles) == size_t(WeatherCondition::Count), "One icon per condition");
+
+} // namespace
+
+static_assert(sizeof(WeatherSnapshot) <= 32, "WeatherSnapshot should stay packed");
+
+bool WeatherSnapshot::set(QByteArrayView name, double value)
+{
+    for (const FieldSetter &setter : setters)
+    {
+        if (name == QByteArrayView(setter.name))
+        {
+            setter.set(*this, value);
+            fields |= setter.field;
+            return true;
+        }
+    }
+    return false;
+}
+
+WeatherCondition WeatherSnapshot::condition() const
+{
+    if (fields == 0)
+    {
+        return WeatherCondition::Unknown;
+    }
+
+    if (snowfall >= 0.1f)
+    {
+        return WeatherCondition::Snow;
+    }
+    if (precipitation >= 0.1f)
+    {
+        return WeatherCondition::Rain;
+    }
+    if (windSpeed >= 8.0f && cloudCover < 20)
+    {
+        return isDay ? WeatherCondition::WindyDay : WeatherCondition::WindyNight;
+    }
+    if (cloudCover >= 80)
+    {
+        return WeatherCondition::Overcast;
+    }
+    if (cloudCover < 20)
+    {
+        return isDay ? WeatherCondition::ClearDay : WeatherCondition::ClearNight;
+    }
+    return isDay ? WeatherCondition::FewCloudsDay : WeatherCondition::FewCloudsNight;
+}
+
+const char *WeatherSnapshot::iconFile(WeatherCondition condition)
+{
+    int index = int(condition);
+    if (index < 0 || index >= int(WeatherCondition::Count))
+    {
+        index = int(WeatherCondition::Unknown);
+    }
+    return iconFiles[index];
+}
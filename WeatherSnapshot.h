@@ -0,0 +1,58 @@
+#ifndef WEATHERSNAPSHOT_H
+#define WEATHERSNAPSHOT_H
+
+#include <QtGlobal>
+#include <QByteArrayView>
+
+// What the weather panel shows, classified from a snapshot
+enum class WeatherCondition : quint8
+{
+    ClearDay,
+    ClearNight,
+    FewCloudsDay,
+    FewCloudsNight,
+    Overcast,
+    Rain,
+    Snow,
+    WindyDay,
+    WindyNight,
+    Unknown,
+    Count
+};
+
+// Current conditions in a few packed numbers. Values missing from a response
+// stay 0 and their bit in `fields` stays clear.
+struct WeatherSnapshot
+{
+    enum Field : quint16
+    {
+        Temperature = 1 << 0,
+        ApparentTemperature = 1 << 1,
+        Precipitation = 1 << 2,
+        Snowfall = 1 << 3,
+        CloudCover = 1 << 4,
+        IsDay = 1 << 5,
+        WindSpeed = 1 << 6,
+        WindDirection = 1 << 7
+    };
+
+    float temperature = 0;          // °C
+    float apparentTemperature = 0;  // °C
+    float precipitation = 0;        // mm
+    float snowfall = 0;             // cm
+    float windSpeed = 0;            // m/s
+    quint16 windDirection = 0;      // degrees
+    quint8 cloudCover = 0;          // percent
+    bool isDay = false;
+    quint16 fields = 0;
+
+    // Store a value under its Open-Meteo name, e.g. "temperature_2m". Returns false for other names.
+    bool set(QByteArrayView name, double value);
+
+    WeatherCondition condition() const;
+
+    // Icon file for a condition, looked up in a table
+    static const char *iconFile(WeatherCondition condition);
+};
+
+#endif // WEATHERSNAPSHOT_H
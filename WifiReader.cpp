@@ -0,0 +1,506 @@
+#include "WifiReader.h"
+
+#include <QDir>
+#include <QDebug>
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+
+namespace {
+
+// Netlink replies for a single interface comfortably fit in this buffer
+constexpr int ReceiveBufferSize = 16384;
+constexpr int RequestBufferSize = 256;
+
+// Read a small sysfs/procfs file into buffer, returns the number of bytes read
+int readSmallFile(const char *path, char *buffer, int size)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int total = 0;
+    while (total < size - 1)
+    {
+        ssize_t count = ::read(fd, buffer + total, size - 1 - total);
+        if (count <= 0)
+        {
+            break;
+        }
+        total += int(count);
+    }
+    ::close(fd);
+    buffer[total < 0 ? 0 : total] = '\0';
+    return total;
+}
+
+// Minimal generic netlink request builder
+struct Request
+{
+    alignas(NLMSG_ALIGNTO) char buffer[RequestBufferSize];
+    nlmsghdr *header;
+
+    Request(int family, int command, int flags, unsigned int sequence)
+    {
+        std::memset(buffer, 0, sizeof(buffer));
+        header = reinterpret_cast<nlmsghdr *>(buffer);
+        header->nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+        header->nlmsg_type = family;
+        header->nlmsg_flags = NLM_F_REQUEST | flags;
+        header->nlmsg_seq = sequence;
+
+        genlmsghdr *genl = static_cast<genlmsghdr *>(NLMSG_DATA(header));
+        genl->cmd = command;
+        genl->version = 1;
+    }
+
+    void addAttribute(int type, const void *data, int length)
+    {
+        nlattr *attr = reinterpret_cast<nlattr *>(buffer + NLMSG_ALIGN(header->nlmsg_len));
+        attr->nla_type = type;
+        attr->nla_len = NLA_HDRLEN + length;
+        std::memcpy(reinterpret_cast<char *>(attr) + NLA_HDRLEN, data, length);
+        header->nlmsg_len = NLMSG_ALIGN(header->nlmsg_len) + NLA_ALIGN(attr->nla_len);
+    }
+};
+
+// Attribute table indexed by attribute type, filled from a nested or top-level payload
+template <int Size>
+struct Attributes
+{
+    const nlattr *table[Size] = {};
+
+    void parse(const char *data, int length)
+    {
+        while (length >= int(NLA_HDRLEN))
+        {
+            const nlattr *attr = reinterpret_cast<const nlattr *>(data);
+            if (attr->nla_len < NLA_HDRLEN || attr->nla_len > length)
+            {
+                break;
+            }
+            int type = attr->nla_type & NLA_TYPE_MASK;
+            if (type < Size)
+            {
+                table[type] = attr;
+            }
+            int aligned = NLA_ALIGN(attr->nla_len);
+            data += aligned;
+            length -= aligned;
+        }
+    }
+
+    void parse(const nlattr *nested)
+    {
+        parse(payload(nested), payloadLength(nested));
+    }
+
+    static const char *payload(const nlattr *attr)
+    {
+        return reinterpret_cast<const char *>(attr) + NLA_HDRLEN;
+    }
+
+    static int payloadLength(const nlattr *attr)
+    {
+        return attr->nla_len - NLA_HDRLEN;
+    }
+
+    template <typename T>
+    T value(int type, T fallback = T()) const
+    {
+        const nlattr *attr = table[type];
+        if (!attr || payloadLength(attr) < int(sizeof(T)))
+        {
+            return fallback;
+        }
+        T result;
+        std::memcpy(&result, payload(attr), sizeof(T));
+        return result;
+    }
+};
+
+// Send a request and hand every reply message's attribute payload to callback.
+// Returns false on socket errors or a netlink error reply.
+template <typename Callback>
+bool transact(int fd, Request &request, Callback callback)
+{
+    if (::send(fd, request.buffer, request.header->nlmsg_len, 0) < 0)
+    {
+        return false;
+    }
+
+    alignas(NLMSG_ALIGNTO) char buffer[ReceiveBufferSize];
+    const unsigned int sequence = request.header->nlmsg_seq;
+    const bool dump = request.header->nlmsg_flags & NLM_F_DUMP;
+
+    for (;;)
+    {
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+
+        int remaining = int(received);
+        for (nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer);
+             NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining))
+        {
+            if (header->nlmsg_seq != sequence)
+            {
+                // Stale reply from an earlier request that timed out
+                continue;
+            }
+            if (header->nlmsg_type == NLMSG_DONE)
+            {
+                return true;
+            }
+            if (header->nlmsg_type == NLMSG_ERROR)
+            {
+                const nlmsgerr *error = static_cast<const nlmsgerr *>(NLMSG_DATA(header));
+                return error->error == 0;
+            }
+
+            const char *payload = static_cast<const char *>(NLMSG_DATA(header)) + GENL_HDRLEN;
+            int length = int(header->nlmsg_len) - NLMSG_LENGTH(GENL_HDRLEN);
+            callback(payload, length);
+
+            if (!dump)
+            {
+                return true;
+            }
+        }
+    }
+}
+
+// Find the first interface in /proc/net/wireless and its signal level in dBm
+bool readProcWireless(char *interfaceName, int nameSize, int *signalDbm)
+{
+    char buffer[1024];
+    if (readSmallFile("/proc/net/wireless", buffer, sizeof(buffer)) <= 0)
+    {
+        return false;
+    }
+
+    // Skip the two header lines
+    const char *line = buffer;
+    for (int i = 0; i < 2 && line; ++i)
+    {
+        line = std::strchr(line, '\n');
+        if (line)
+        {
+            ++line;
+        }
+    }
+    if (!line || !*line)
+    {
+        return false;
+    }
+
+    while (*line == ' ')
+    {
+        ++line;
+    }
+    const char *colon = std::strchr(line, ':');
+    if (!colon || colon - line >= nameSize)
+    {
+        return false;
+    }
+    std::memcpy(interfaceName, line, colon - line);
+    interfaceName[colon - line] = '\0';
+
+    // Columns after the name: status, link quality, signal level
+    char *cursor = const_cast<char *>(colon + 1);
+    std::strtol(cursor, &cursor, 16);
+    std::strtol(cursor, &cursor, 10);
+    if (*cursor == '.')
+    {
+        ++cursor;
+    }
+    *signalDbm = int(std::strtol(cursor, &cursor, 10));
+    return true;
+}
+
+QString modeName(unsigned int type)
+{
+    switch (type)
+    {
+    case NL80211_IFTYPE_STATION: return "Infra";
+    case NL80211_IFTYPE_ADHOC: return "Ad-Hoc";
+    case NL80211_IFTYPE_AP: return "AP";
+    case NL80211_IFTYPE_MESH_POINT: return "Mesh";
+    default: return "Unknown";
+    }
+}
+
+} // namespace
+
+WifiReader::WifiReader()
+    : netlinkSocket(-1),
+    nl80211Family(-1),
+    nl80211Missing(false),
+    sequence(0)
+{
+    scanRfkill();
+}
+
+// Destructor
+WifiReader::~WifiReader()
+{
+    closeNetlink();
+}
+
+void WifiReader::scanRfkill()
+{
+    rfkillSoftPaths.clear();
+    rfkillHardPaths.clear();
+
+    // Only switches of type "wlan" control the Wi-Fi radio
+    QDir rfkillDir("/sys/class/rfkill");
+    const QStringList entries = rfkillDir.entryList(QStringList() << "rfkill*", QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries)
+    {
+        QByteArray path = rfkillDir.filePath(entry).toLocal8Bit();
+        char type[32];
+        if (readSmallFile(QByteArray(path + "/type").constData(), type, sizeof(type)) > 0 && std::strncmp(type, "wlan", 4) == 0)
+        {
+            rfkillSoftPaths.append(path + "/soft");
+            rfkillHardPaths.append(path + "/hard");
+        }
+    }
+}
+
+WifiReader::RadioState WifiReader::radioState()
+{
+    if (rfkillSoftPaths.isEmpty())
+    {
+        return RadioState::Unknown;
+    }
+
+    // The radio is on when any wlan switch is neither soft nor hard blocked
+    bool anyReadable = false;
+    for (int i = 0; i < rfkillSoftPaths.size(); ++i)
+    {
+        char soft[8];
+        char hard[8];
+        if (readSmallFile(rfkillSoftPaths.at(i).constData(), soft, sizeof(soft)) <= 0 ||
+            readSmallFile(rfkillHardPaths.at(i).constData(), hard, sizeof(hard)) <= 0)
+        {
+            continue;
+        }
+        anyReadable = true;
+        if (soft[0] == '0' && hard[0] == '0')
+        {
+            return RadioState::Enabled;
+        }
+    }
+
+    if (!anyReadable)
+    {
+        // Adapter was removed, look again next time
+        scanRfkill();
+        return RadioState::Unknown;
+    }
+    return RadioState::Disabled;
+}
+
+bool WifiReader::openNetlink()
+{
+    if (netlinkSocket >= 0)
+    {
+        return true;
+    }
+    if (nl80211Missing)
+    {
+        return false;
+    }
+
+    netlinkSocket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (netlinkSocket < 0)
+    {
+        return false;
+    }
+
+    // Never let a stuck kernel reply hold up the caller for long
+    timeval timeout{0, 200000};
+    ::setsockopt(netlinkSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    if (::bind(netlinkSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        closeNetlink();
+        return false;
+    }
+
+    // Resolve the nl80211 family id once, it stays the same until reboot
+    Request request(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0, ++sequence);
+    static const char familyName[] = NL80211_GENL_NAME;
+    request.addAttribute(CTRL_ATTR_FAMILY_NAME, familyName, sizeof(familyName));
+
+    bool ok = transact(netlinkSocket, request, [this](const char *payload, int length) {
+        Attributes<CTRL_ATTR_MAX + 1> attrs;
+        attrs.parse(payload, length);
+        nl80211Family = attrs.value<quint16>(CTRL_ATTR_FAMILY_ID, 0);
+    });
+
+    if (!ok || nl80211Family <= 0)
+    {
+        // Asked once per reader, not on every sample
+        qDebug() << "nl80211 is not available, falling back to nmcli";
+        nl80211Missing = true;
+        closeNetlink();
+        return false;
+    }
+    return true;
+}
+
+void WifiReader::closeNetlink()
+{
+    if (netlinkSocket >= 0)
+    {
+        ::close(netlinkSocket);
+    }
+    netlinkSocket = -1;
+    nl80211Family = -1;
+}
+
+bool WifiReader::readLink(LinkDetails *details)
+{
+    *details = LinkDetails();
+
+    char interfaceName[IF_NAMESIZE];
+    int signalDbm = 0;
+    bool haveProcSignal = readProcWireless(interfaceName, sizeof(interfaceName), &signalDbm);
+    if (!haveProcSignal || !openNetlink())
+    {
+        return false;
+    }
+
+    quint32 interfaceIndex = if_nametoindex(interfaceName);
+    if (interfaceIndex == 0)
+    {
+        return false;
+    }
+    details->device = QString::fromLatin1(interfaceName);
+    details->signal = signalToPercent(signalDbm);
+
+    // SSID, mode and operating frequency of the interface
+    Request interfaceRequest(nl80211Family, NL80211_CMD_GET_INTERFACE, 0, ++sequence);
+    interfaceRequest.addAttribute(NL80211_ATTR_IFINDEX, &interfaceIndex, sizeof(interfaceIndex));
+    bool ok = transact(netlinkSocket, interfaceRequest, [details](const char *payload, int length) {
+        Attributes<NL80211_ATTR_MAX + 1> attrs;
+        attrs.parse(payload, length);
+
+        if (const nlattr *ssid = attrs.table[NL80211_ATTR_SSID])
+        {
+            details->connected = true;
+            details->ssid = QString::fromUtf8(attrs.payload(ssid), attrs.payloadLength(ssid));
+        }
+        details->mode = modeName(attrs.value<quint32>(NL80211_ATTR_IFTYPE));
+        details->channel = frequencyToChannel(int(attrs.value<quint32>(NL80211_ATTR_WIPHY_FREQ)));
+    });
+    if (!ok)
+    {
+        closeNetlink();
+        return false;
+    }
+    if (!details->connected)
+    {
+        return true;
+    }
+
+    // BSSID and transmit bitrate come from the station entry of the access point
+    Request stationRequest(nl80211Family, NL80211_CMD_GET_STATION, NLM_F_DUMP, ++sequence);
+    stationRequest.addAttribute(NL80211_ATTR_IFINDEX, &interfaceIndex, sizeof(interfaceIndex));
+    ok = transact(netlinkSocket, stationRequest, [details](const char *payload, int length) {
+        Attributes<NL80211_ATTR_MAX + 1> attrs;
+        attrs.parse(payload, length);
+
+        const nlattr *mac = attrs.table[NL80211_ATTR_MAC];
+        if (mac && attrs.payloadLength(mac) >= 6 && details->bssid.isEmpty())
+        {
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(attrs.payload(mac));
+            details->bssid = QString::asprintf("%02X:%02X:%02X:%02X:%02X:%02X",
+                                               bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5]);
+        }
+
+        const nlattr *stationInfo = attrs.table[NL80211_ATTR_STA_INFO];
+        if (!stationInfo)
+        {
+            return;
+        }
+        Attributes<NL80211_STA_INFO_MAX + 1> info;
+        info.parse(stationInfo);
+
+        if (const nlattr *txBitrate = info.table[NL80211_STA_INFO_TX_BITRATE])
+        {
+            Attributes<NL80211_RATE_INFO_MAX + 1> rate;
+            rate.parse(txBitrate);
+
+            // Both attributes are in units of 100 kbit/s
+            quint32 bitrate = rate.value<quint32>(NL80211_RATE_INFO_BITRATE32, 0);
+            if (bitrate == 0)
+            {
+                bitrate = rate.value<quint16>(NL80211_RATE_INFO_BITRATE, 0);
+            }
+            details->rateMbps = int(bitrate / 10);
+        }
+    });
+    if (!ok)
+    {
+        closeNetlink();
+        return false;
+    }
+    return true;
+}
+
+WifiReader::Sample WifiReader::sample()
+{
+    Sample result;
+    result.radio = radioState();
+    if (result.radio != RadioState::Disabled)
+    {
+        result.linkRead = readLink(&result.link);
+    }
+    return result;
+}
+
+int WifiReader::frequencyToChannel(int frequency)
+{
+    if (frequency == 2484)
+    {
+        return 14;
+    }
+    if (frequency >= 2412 && frequency < 2484)
+    {
+        return (frequency - 2407) / 5;
+    }
+    if (frequency >= 5955 && frequency <= 7115)
+    {
+        return (frequency - 5950) / 5;
+    }
+    if (frequency >= 5000 && frequency <= 5885)
+    {
+        return (frequency - 5000) / 5;
+    }
+    if (frequency >= 4910 && frequency <= 4980)
+    {
+        // 4.9 GHz public safety band, numbered from 4 GHz like the kernel does
+        return (frequency - 4000) / 5;
+    }
+    return 0;
+}
+
+int WifiReader::signalToPercent(int dbm)
+{
+    return qBound(0, 2 * (dbm + 100), 100);
+}
@@ -0,0 +1,78 @@
+#ifndef WIFIREADER_H
+#define WIFIREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArrayList>
+#include <QMetaType>
+
+// Reads Wi-Fi radio state and link details straight from the kernel
+// (rfkill in sysfs, /proc/net/wireless and nl80211 over generic netlink)
+// so the network panel does not have to fork nmcli for every update.
+class WifiReader
+{
+public:
+    enum class RadioState
+    {
+        Unknown,
+        Enabled,
+        Disabled
+    };
+
+    struct LinkDetails
+    {
+        bool connected = false;
+        QString device;
+        QString ssid;
+        QString bssid;
+        QString mode;
+        int channel = 0;
+        int rateMbps = 0;
+        int signal = 0; // Percent, same scale as nmcli
+    };
+
+    // Radio state plus the link when the radio is not off, read in one go
+    struct Sample
+    {
+        RadioState radio = RadioState::Unknown;
+        bool linkRead = false;
+        LinkDetails link;
+    };
+
+    WifiReader();
+    ~WifiReader();
+
+    WifiReader(const WifiReader &) = delete;
+    WifiReader &operator=(const WifiReader &) = delete;
+
+    // Unknown when no wlan rfkill switch exists, callers should fall back to nmcli
+    RadioState radioState();
+
+    // Returns false when the link could not be read natively
+    bool readLink(LinkDetails *details);
+
+    // Not thread-safe, callers serialise access to one reader
+    Sample sample();
+
+    // Map a centre frequency in MHz to its channel number
+    static int frequencyToChannel(int frequency);
+
+    // Convert dBm to the percentage scale NetworkManager reports
+    static int signalToPercent(int dbm);
+
+private:
+    void scanRfkill();
+    bool openNetlink();
+    void closeNetlink();
+
+    QByteArrayList rfkillSoftPaths;
+    QByteArrayList rfkillHardPaths;
+    int netlinkSocket;
+    int nl80211Family;
+    bool nl80211Missing; // the family could not be resolved, nmcli is used from then on
+    unsigned int sequence;
+};
+
+Q_DECLARE_METATYPE(WifiReader::Sample)
+
+#endif // WIFIREADER_H
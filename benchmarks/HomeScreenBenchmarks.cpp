@@ -0,0 +1,838 @@
+#include "HomeScreen.h"
+#include "DeviceModel.h"
+#include "DeviceRegistry.h"
+#include "DeviceTileDelegate.h"
+#include "IconCache.h"
+#include "NetworkControls.h"
+#include "PanelSnapshot.h"
+#include "SecurityCollectors.h"
+#include "SecurityControls.h"
+#include "SocketTable.h"
+#include "StaticTextLabel.h"
+#include "SwipeGesture.h"
+#include "Theme.h"
+#include "TileGrid.h"
+#include "Weather.h"
+
+#include <QApplication>
+#include <QFile>
+#include <QMouseEvent>
+#include <QGridLayout>
+#include <QListView>
+#include <QPainter>
+#include <QPushButton>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#ifdef __GLIBC__
+// Count heap allocations per thread by wrapping glibc's allocator, Qt's
+// containers allocate through malloc rather than operator new
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+static thread_local quint64 threadAllocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    ++threadAllocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    ++threadAllocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    ++threadAllocations;
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+namespace {
+
+// How Weather parsed the script output and HomeScreen classified it before
+// WeatherSnapshot, kept as the baseline for the allocation benchmark
+QString legacyParseAndClassify(const QByteArray &rawOutput)
+{
+    QString temperature, precipitation, cloudCover, isDay, windSpeed, snowfall;
+
+    QString output = QString::fromLocal8Bit(rawOutput);
+    const QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines)
+    {
+        QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() < 3) continue;
+        if (line.startsWith("Current temperature_2m")) temperature = parts.last().trimmed();
+        else if (line.startsWith("Current precipitation")) precipitation = parts.last().trimmed();
+        else if (line.startsWith("Current cloud_cover")) cloudCover = parts.last().trimmed();
+        else if (line.startsWith("Current is_day")) isDay = parts.last().trimmed();
+        else if (line.startsWith("Current wind_speed_10m")) windSpeed = parts.last().trimmed();
+        else if (line.startsWith("Current snowfall")) snowfall = parts.last().trimmed();
+    }
+
+    const double precipVal = precipitation.toDouble();
+    const double cloudVal = cloudCover.toDouble();
+    const double windVal = windSpeed.toDouble();
+    const double snowVal = snowfall.toDouble();
+    const bool day = (isDay.toDouble() == 1.0);
+
+    if (snowVal >= 0.1) return "Snow";
+    if (precipVal >= 0.1) return "Rain";
+    if (windVal >= 8.0 && cloudVal < 20.0) return day ? "Windy-Day" : "Windy-Night";
+    if (cloudVal >= 80.0) return "Overcast";
+    if (cloudVal < 20.0) return day ? "Clear-Day" : "Clear-Night";
+    return day ? "Few-Clouds-Day" : "Few-Clouds-Night";
+}
+
+} // namespace
+
+// Benchmarks for the text parsers and the panel rebuild paths. Each parser runs
+// on a recorded fixture ("realistic") and on a synthetic table built from the
+// same lines ("stress"). Results are written as Qt Test XML unless -o is given.
+class HomeScreenBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void weatherParseOutput_data();
+    void weatherParseOutput();
+    void weatherAllocations_data();
+    void weatherAllocations();
+
+    void openMeteoResponse_data();
+    void openMeteoResponse();
+
+    void nmcliDetails_data();
+    void nmcliDetails();
+
+    void ssOutput_data();
+    void ssOutput();
+
+    void procNetTable_data();
+    void procNetTable();
+
+    void weatherIcon_data();
+    void weatherIcon();
+
+    void selectionToggle_data();
+    void selectionToggle();
+
+    void itemPanelBuild_data();
+    void itemPanelBuild();
+
+    void areaButtonClicked();
+    void itemTileClicked_data();
+    void itemTileClicked();
+    void optionPanelFrame_data();
+    void optionPanelFrame();
+    void eventDispatch_data();
+    void eventDispatch();
+    void clockTick_data();
+    void clockTick();
+    void deviceUpdates_data();
+    void deviceUpdates();
+
+private:
+    static QByteArray fixture(const char *name);
+
+    // The header of a fixture followed by its body lines repeated until there are `lines` of them
+    static QByteArray repeatBody(const QByteArray &table, int lines);
+
+    QPushButton *findButton(const QString &text) const;
+
+    // Click the tile with the given text on the shown item panel page
+    bool clickTile(const QString &text) const;
+
+    HomeScreen *homeScreen = nullptr;
+};
+
+QByteArray HomeScreenBenchmarks::fixture(const char *name)
+{
+    QFile file(QFINDTESTDATA(QString("fixtures/") + name));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qFatal("Missing fixture %s", name);
+    }
+    return file.readAll();
+}
+
+QByteArray HomeScreenBenchmarks::repeatBody(const QByteArray &table, int lines)
+{
+    const int headerEnd = table.indexOf('\n') + 1;
+    const QByteArrayList body = table.mid(headerEnd).split('\n');
+
+    QByteArray result = table.left(headerEnd);
+    int written = 0;
+    while (written < lines)
+    {
+        for (const QByteArray &line : body)
+        {
+            if (line.isEmpty())
+            {
+                continue;
+            }
+            result += line + '\n';
+            if (++written == lines)
+            {
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+QPushButton *HomeScreenBenchmarks::findButton(const QString &text) const
+{
+    const QList<QPushButton *> buttons = homeScreen->findChildren<QPushButton *>();
+    for (QPushButton *button : buttons)
+    {
+        if (button->text() == text)
+        {
+            return button;
+        }
+    }
+    return nullptr;
+}
+
+bool HomeScreenBenchmarks::clickTile(const QString &text) const
+{
+    TileGrid *grid = nullptr;
+    const QList<TileGrid *> pages = homeScreen->findChildren<TileGrid *>();
+    for (TileGrid *page : pages)
+    {
+        if (page->isVisible())
+        {
+            grid = page;
+        }
+    }
+    const int tile = grid ? grid->findTile(text) : -1;
+    if (tile < 0)
+    {
+        return false;
+    }
+    QTest::mouseClick(grid, Qt::LeftButton, Qt::NoModifier, grid->tileRect(tile).center());
+    return true;
+}
+
+void HomeScreenBenchmarks::initTestCase()
+{
+    homeScreen = new HomeScreen();
+    homeScreen->resize(2000, 1200);
+    QVERIFY(QTest::qWaitForWindowExposed(homeScreen));
+}
+
+void HomeScreenBenchmarks::cleanupTestCase()
+{
+    delete homeScreen;
+    homeScreen = nullptr;
+}
+
+void HomeScreenBenchmarks::weatherParseOutput_data()
+{
+    QTest::addColumn<QByteArray>("output");
+
+    const QByteArray current = fixture("weather.txt");
+    QTest::newRow("realistic") << current;
+
+    // A script that also prints the hourly forecast
+    QByteArray hourly;
+    for (int i = 0; i < 2000; ++i)
+    {
+        hourly += "Hourly temperature_2m " + QByteArray::number(10.0 + (i % 70) / 10.0) + '\n';
+    }
+    QTest::newRow("stress") << current + hourly;
+}
+
+void HomeScreenBenchmarks::weatherParseOutput()
+{
+    QFETCH(QByteArray, output);
+
+    WeatherSnapshot snapshot;
+    QBENCHMARK {
+        Weather::parseOutput(output, &snapshot);
+    }
+    QVERIFY(qFuzzyCompare(snapshot.temperature, 11.85f));
+    QCOMPARE(snapshot.condition(), WeatherCondition::FewCloudsDay);
+}
+
+void HomeScreenBenchmarks::weatherAllocations_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("QString fields") << true;
+    QTest::newRow("WeatherSnapshot") << false;
+}
+
+void HomeScreenBenchmarks::weatherAllocations()
+{
+#ifdef __GLIBC__
+    QFETCH(bool, legacy);
+
+    const QByteArray output = fixture("weather.txt");
+    WeatherSnapshot snapshot;
+    QString conditionKey;
+
+    // One parse plus classification, counted on this thread only
+    const quint64 before = threadAllocations;
+    if (legacy)
+    {
+        conditionKey = legacyParseAndClassify(output);
+    }
+    else
+    {
+        Weather::parseOutput(output, &snapshot);
+        snapshot.condition();
+    }
+    const quint64 allocations = threadAllocations - before;
+
+    qInfo() << (legacy ? "QString fields:" : "WeatherSnapshot:") << allocations << "allocations per update";
+    QTest::setBenchmarkResult(qreal(allocations), QTest::Events);
+#else
+    QSKIP("Allocation counting needs glibc");
+#endif
+}
+
+void HomeScreenBenchmarks::openMeteoResponse_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    const QByteArray response = fixture("open-meteo.json");
+    QTest::newRow("realistic") << response;
+
+    // The same response with a week of hourly data in front of the current conditions
+    QByteArray hourly = "{\"hourly\":{\"temperature_2m\":[";
+    for (int i = 0; i < 168 * 20; ++i)
+    {
+        hourly += (i ? "," : "") + QByteArray::number(10.0 + (i % 70) / 10.0);
+    }
+    hourly += "]},";
+    QTest::newRow("stress") << hourly + response.mid(response.indexOf('{') + 1);
+}
+
+void HomeScreenBenchmarks::openMeteoResponse()
+{
+    QFETCH(QByteArray, json);
+
+    WeatherSnapshot snapshot;
+    bool parsed = false;
+    QBENCHMARK {
+        parsed = Weather::parseOpenMeteo(json, &snapshot);
+    }
+    QVERIFY(parsed);
+    QVERIFY(qFuzzyCompare(snapshot.temperature, 11.9f));
+    QVERIFY(qFuzzyCompare(snapshot.windSpeed, 3.9f));
+}
+
+void HomeScreenBenchmarks::nmcliDetails_data()
+{
+    QTest::addColumn<QString>("output");
+
+    const QByteArray scan = fixture("nmcli-wifi.txt");
+    QTest::newRow("realistic") << QString::fromUtf8(scan);
+
+    // A crowded scan with the active network near the end
+    QByteArray crowded = repeatBody(scan, 500);
+    crowded.replace("yes     ", "no      ");
+    crowded += "yes     HomeNet-5G          B0:BE:76:4D:22:91  Infra  36    540 Mbit/s  78      wlan0  \n";
+    QTest::newRow("stress") << QString::fromUtf8(crowded);
+}
+
+void HomeScreenBenchmarks::nmcliDetails()
+{
+    QFETCH(QString, output);
+
+    QStringList details;
+    QBENCHMARK {
+        details = NetworkControls::parseNmcliDetails(output);
+    }
+    QCOMPARE(details.value(0), QString("SSID: HomeNet-5G"));
+}
+
+void HomeScreenBenchmarks::ssOutput_data()
+{
+    QTest::addColumn<QString>("output");
+    QTest::addColumn<int>("sockets");
+
+    const QByteArray table = fixture("ss-tuln.txt");
+    QTest::newRow("realistic") << QString::fromUtf8(table) << 18;
+    QTest::newRow("stress") << QString::fromUtf8(repeatBody(table, 10000)) << 10000;
+}
+
+void HomeScreenBenchmarks::ssOutput()
+{
+    QFETCH(QString, output);
+    QFETCH(int, sockets);
+
+    QStringList lines;
+    QBENCHMARK {
+        lines = SecurityCollectors::parseSsOutput(output);
+    }
+    QCOMPARE(lines.size(), sockets);
+}
+
+void HomeScreenBenchmarks::procNetTable_data()
+{
+    QTest::addColumn<QByteArray>("table");
+    QTest::addColumn<int>("listening");
+
+    // The fixture has six listening sockets among ten entries
+    const QByteArray table = fixture("proc-net-tcp.txt");
+    QTest::newRow("realistic") << table << 6;
+    QTest::newRow("stress") << repeatBody(table, 10000) << 6000;
+}
+
+void HomeScreenBenchmarks::procNetTable()
+{
+    QFETCH(QByteArray, table);
+    QFETCH(int, listening);
+
+    // Includes building the panel lines, like the ss parser above
+    SocketTable sockets;
+    QStringList lines;
+    QBENCHMARK {
+        sockets.clear();
+        sockets.parse(table.constData(), table.size(), SocketTable::Tcp);
+        lines = sockets.toLines();
+    }
+    QCOMPARE(lines.size(), listening);
+}
+
+void HomeScreenBenchmarks::weatherIcon_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("decode, recolour, scale") << false;
+    QTest::newRow("IconCache") << true;
+}
+
+void HomeScreenBenchmarks::weatherIcon()
+{
+    QFETCH(bool, cached);
+
+    // A stand-in for the symbolic icons, same size as the originals
+    QTemporaryDir dir;
+    const QString path = dir.filePath("icon.png");
+    QImage source(256, 256, QImage::Format_ARGB32);
+    source.fill(Qt::transparent);
+    QPainter sourcePainter(&source);
+    sourcePainter.setBrush(Qt::black);
+    sourcePainter.drawEllipse(source.rect().adjusted(16, 16, -16, -16));
+    sourcePainter.end();
+    QVERIFY(source.save(path));
+
+    IconCache::Key key;
+    key.source = path;
+    key.size = QSize(100, 100);
+
+    QPixmap icon;
+    if (cached)
+    {
+        IconCache::instance()->pixmap(key);
+        QBENCHMARK {
+            icon = IconCache::instance()->pixmap(key);
+        }
+    }
+    else
+    {
+        // What updateWeatherPanel did on every refresh before the cache
+        QBENCHMARK {
+            QPixmap original(path);
+            QImage image = original.toImage().convertToFormat(QImage::Format_ARGB32);
+            QPixmap colored(image.size());
+            colored.fill(Qt::transparent);
+            QPainter painter(&colored);
+            painter.drawImage(0, 0, image);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+            painter.fillRect(image.rect(), Qt::white);
+            painter.end();
+            icon = colored.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+    QVERIFY(!icon.isNull());
+}
+
+void HomeScreenBenchmarks::selectionToggle_data()
+{
+    QTest::addColumn<QString>("method");
+
+    QTest::newRow("setStyleSheet") << "setStyleSheet";
+    QTest::newRow("Theme::setSelected") << "theme";
+    QTest::newRow("TileGrid::select") << "grid";
+}
+
+void HomeScreenBenchmarks::selectionToggle()
+{
+    QFETCH(QString, method);
+
+    QWidget window;
+    window.resize(400, 400);
+    QPushButton *button = new QPushButton("Network", &window);
+    button->setFixedSize(350, 350);
+    Theme::setRole(button, "area");
+
+    TileGrid *grid = new TileGrid(&window);
+    grid->setCellSize(170, 10);
+    grid->addTile(0, "Network", 0, 0, 2, 0);
+    grid->addTile(1, "Lights", 0, 2, 2, 0);
+    grid->resize(grid->sizeHint());
+    grid->setVisible(method == "grid");
+    button->setVisible(method != "grid");
+
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    // One select or deselect including its repaint, toggles per second is the inverse
+    bool selected = false;
+    QBENCHMARK {
+        selected = !selected;
+        if (method == "grid")
+        {
+            grid->select(selected ? 0 : 1);
+            grid->repaint();
+        }
+        else if (method == "theme")
+        {
+            Theme::setSelected(button, selected);
+            button->repaint();
+        }
+        else
+        {
+            // What the click handlers did before the application theme
+            button->setStyleSheet(selected
+                                  ? "background-color: rgba(58,94,171,255); color: white; border-radius: 5px;"
+                                  : "background-color: rgba(27,33,52,200); color: white; border-radius: 5px;");
+            button->repaint();
+        }
+    }
+}
+
+void HomeScreenBenchmarks::itemPanelBuild_data()
+{
+    QTest::addColumn<bool>("painted");
+    QTest::addColumn<int>("tiles");
+
+    QTest::newRow("buttons, 9 tiles") << false << 9;
+    QTest::newRow("TileGrid, 9 tiles") << true << 9;
+    QTest::newRow("buttons, 64 tiles") << false << 64;
+    QTest::newRow("TileGrid, 64 tiles") << true << 64;
+}
+
+void HomeScreenBenchmarks::itemPanelBuild()
+{
+    QFETCH(bool, painted);
+    QFETCH(int, tiles);
+
+    QWidget window;
+    window.resize(1600, 1600);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    // Build a panel, lay it out, paint it once and tear it down again
+    QBENCHMARK {
+        if (painted)
+        {
+            TileGrid *grid = new TileGrid(&window);
+            for (int i = 0; i < tiles; ++i)
+            {
+                grid->addTile(i, QString::number(i), i / 8, i % 8);
+            }
+            grid->resize(window.size());
+            grid->show();
+            grid->repaint();
+            delete grid;
+        }
+        else
+        {
+            // How allDevicesButtons built the panel before TileGrid
+            QWidget *panel = new QWidget(&window);
+            QGridLayout *layout = new QGridLayout(panel);
+            layout->setSpacing(10);
+            for (int i = 0; i < tiles; ++i)
+            {
+                QPushButton *button = new QPushButton(QString::number(i));
+                button->setFixedSize(170, 170);
+                button->setStyleSheet("background-color: rgba(27,33,52,200); color: white; border-radius: 5px;");
+                QFont font;
+                font.setPointSize(16);
+                font.setFamily("Arial");
+                font.setBold(true);
+                button->setFont(font);
+                layout->addWidget(button, i / 8, i % 8);
+            }
+            panel->resize(window.size());
+            panel->show();
+            panel->repaint();
+            delete panel;
+        }
+    }
+}
+
+void HomeScreenBenchmarks::areaButtonClicked()
+{
+    // Pages are built on the first visit, afterwards a switch only flips the shown page
+    bool showPc = true;
+    QBENCHMARK {
+        QPushButton *button = findButton(showPc ? "PC" : "All Devices");
+        QVERIFY(button);
+        button->click();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        showPc = !showPc;
+    }
+    findButton("All Devices")->click();
+}
+
+void HomeScreenBenchmarks::itemTileClicked_data()
+{
+    QTest::addColumn<QString>("area");
+    QTest::addColumn<QString>("item");
+
+    QTest::newRow("network") << "All Devices" << "Network";
+    QTest::newRow("security") << "PC" << "Security";
+}
+
+void HomeScreenBenchmarks::itemTileClicked()
+{
+    QFETCH(QString, area);
+    QFETCH(QString, item);
+
+    QPushButton *areaButton = findButton(area);
+    QVERIFY(areaButton);
+    areaButton->click();
+
+    // Each tap shows the shared control and starts the slide-in animation
+    QBENCHMARK {
+        QVERIFY(clickTile(item));
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+    findButton("All Devices")->click();
+
+    // However many taps were measured, there is only ever one instance of each control
+    QCOMPARE(homeScreen->findChildren<NetworkControls *>().size(), 1);
+    QVERIFY(homeScreen->findChildren<SecurityControls *>().size() <= 1);
+}
+
+void HomeScreenBenchmarks::optionPanelFrame_data()
+{
+    QTest::addColumn<bool>("snapshot");
+
+    QTest::newRow("live geometry") << false;
+    QTest::newRow("PanelSnapshot") << true;
+}
+
+void HomeScreenBenchmarks::optionPanelFrame()
+{
+    QFETCH(bool, snapshot);
+
+    // Open the network panel and wait for it to settle
+    QVERIFY(clickTile("Network"));
+    QWidget *panel = homeScreen->findChild<QWidget *>("optionPanel");
+    QVERIFY(panel);
+    QTRY_VERIFY(panel->isVisible());
+
+    QWidget *central = homeScreen->centralWidget();
+    const QRect open = panel->geometry();
+
+    PanelSnapshot picture(central);
+    if (snapshot)
+    {
+        picture.capture(panel, open.topLeft());
+        panel->hide();
+    }
+
+    // One animation frame: move the panel 10px and repaint everything that changed
+    QWidget *moved = snapshot ? static_cast<QWidget *>(&picture) : panel;
+    int offset = 0;
+    QBENCHMARK {
+        const QRect before = moved->geometry();
+        offset = (offset + 10) % 200;
+        if (snapshot)
+        {
+            picture.move(open.topLeft() + QPoint(0, offset));
+        }
+        else
+        {
+            // What animatePanel and mouseMoveEvent did before the snapshot
+            panel->setGeometry(open.translated(0, offset));
+        }
+        central->repaint(before.united(moved->geometry()));
+    }
+
+    picture.release();
+    panel->setGeometry(open);
+    panel->show();
+}
+
+void HomeScreenBenchmarks::eventDispatch_data()
+{
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("no filter") << "none";
+    QTest::newRow("application filter") << "application";
+    QTest::newRow("SwipeGesture on the widget") << "swipe";
+}
+
+void HomeScreenBenchmarks::eventDispatch()
+{
+    QFETCH(QString, filter);
+
+    QWidget receiver;
+    receiver.resize(200, 200);
+    receiver.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&receiver));
+
+    // HomeScreen used to filter every event of the application
+    if (filter == "application")
+    {
+        qApp->installEventFilter(homeScreen);
+    }
+    SwipeGesture *swipe = filter == "swipe" ? new SwipeGesture(&receiver) : nullptr;
+
+    // One mouse move delivered to a widget, the most frequent event during a drag
+    QMouseEvent move(QEvent::MouseMove, QPointF(100, 100), QPointF(100, 100), QPointF(100, 100),
+                     Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+    QBENCHMARK {
+        QCoreApplication::sendEvent(&receiver, &move);
+    }
+
+    qApp->removeEventFilter(homeScreen);
+    delete swipe;
+}
+
+void HomeScreenBenchmarks::clockTick_data()
+{
+    QTest::addColumn<bool>("staticText");
+
+    QTest::newRow("QLabel") << false;
+    QTest::newRow("StaticTextLabel") << true;
+}
+
+void HomeScreenBenchmarks::clockTick()
+{
+    QFETCH(bool, staticText);
+
+    QWidget window;
+    window.resize(300, 100);
+
+    QFont font;
+    font.setPointSize(20);
+    font.setFamily("Arial");
+    font.setBold(true);
+
+    QLabel *label = new QLabel("12:59", &window);
+    StaticTextLabel *clockLabel = new StaticTextLabel("12:59", &window);
+    label->setFont(font);
+    clockLabel->setFont(font);
+    label->adjustSize();
+    clockLabel->adjustSize();
+    label->setVisible(!staticText);
+    clockLabel->setVisible(staticText);
+
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    // One minute change and the paint it schedules
+    bool later = false;
+    QBENCHMARK {
+        later = !later;
+        const QString text = later ? "13:00" : "12:59";
+        if (staticText)
+        {
+            clockLabel->setText(text);
+        }
+        else
+        {
+            label->setText(text);
+        }
+        QCoreApplication::sendPostedEvents();
+        QCoreApplication::processEvents();
+    }
+}
+
+void HomeScreenBenchmarks::deviceUpdates_data()
+{
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("flush per update") << false;
+    QTest::newRow("batched flush") << true;
+}
+
+void HomeScreenBenchmarks::deviceUpdates()
+{
+    QFETCH(bool, batched);
+
+    // 10k devices spread over four rooms, two of them shown through models
+    const QStringList rooms = {"Bedroom", "Living Room", "Kitchen", "Garage"};
+    DeviceRegistry registry;
+    for (quint32 id = 0; id < 10000; ++id)
+    {
+        registry.add(id, QString("Light %1").arg(id), DeviceRegistry::Light, rooms.at(id % rooms.size()), 0);
+    }
+
+    QListView view;
+    view.setViewMode(QListView::IconMode);
+    view.setUniformItemSizes(true);
+    view.setItemDelegate(new DeviceTileDelegate(170, &view));
+    DeviceModel *bedroom = new DeviceModel(&registry, "Bedroom", &view);
+    DeviceModel kitchen(&registry, "Kitchen");
+    view.setModel(bedroom);
+    view.resize(1200, 900);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    QCOMPARE(bedroom->rowCount(), 2500);
+
+    QSignalSpy changes(bedroom, &QAbstractItemModel::dataChanged);
+
+    // One second of traffic: 1k state changes, then the frame that shows them
+    quint32 next = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+        {
+            next = (next * 1103515245u + 12345u) % 10000;
+            registry.setState(next, int(i & 1));
+            if (!batched)
+            {
+                registry.flush();
+            }
+        }
+        registry.flush();
+        QCoreApplication::processEvents();
+    }
+    qDebug() << "dataChanged signals on one model:" << changes.count();
+}
+
+int main(int argc, char *argv[])
+{
+    // Widgets are benchmarked without a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    // A long run must not go idle and swallow the simulated clicks
+    if (qEnvironmentVariableIsEmpty("HOMESCREEN_IDLE_MINUTES"))
+    {
+        qputenv("HOMESCREEN_IDLE_MINUTES", "0");
+    }
+
+    QApplication app(argc, argv);
+    Theme::apply(&app);
+    HomeScreenBenchmarks benchmarks;
+
+    // Write machine-readable results by default so runs can be compared across commits
+    QStringList arguments = app.arguments();
+    if (!arguments.contains("-o"))
+    {
+        QString output = qEnvironmentVariable("HOMESCREEN_BENCH_OUTPUT", "benchmarks.xml");
+        arguments << "-o" << output + ",xml" << "-o" << "-,txt";
+    }
+    return QTest::qExec(&benchmarks, arguments);
+}
+
+#include "HomeScreenBenchmarks.moc"
@@ -0,0 +1,87 @@
+QT       += core gui network dbus concurrent widgets testlib
+
+lessThan(QT_MAJOR_VERSION, 6): error("HomeScreen needs Qt 6, found Qt $$QT_VERSION")
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = homescreen-benchmarks
+
+# Benchmark optimised code even from a debug configuration
+CONFIG += release
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    HomeScreenBenchmarks.cpp \
+    $$PWD/../CommandStats.cpp \
+    $$PWD/../ControlRegistry.cpp \
+    $$PWD/../DetailView.cpp \
+    $$PWD/../DeviceModel.cpp \
+    $$PWD/../DeviceRegistry.cpp \
+    $$PWD/../DeviceTileDelegate.cpp \
+    $$PWD/../HomeScreen.cpp \
+    $$PWD/../IconCache.cpp \
+    $$PWD/../IdleMonitor.cpp \
+    $$PWD/../MinuteClock.cpp \
+    $$PWD/../NetworkControls.cpp \
+    $$PWD/../NetworkManagerWatcher.cpp \
+    $$PWD/../PanelSnapshot.cpp \
+    $$PWD/../ProbeEngine.cpp \
+    $$PWD/../ProbeScheduler.cpp \
+    $$PWD/../SecurityCollectors.cpp \
+    $$PWD/../SecurityControls.cpp \
+    $$PWD/../SocketTable.cpp \
+    $$PWD/../StallWatchdog.cpp \
+    $$PWD/../StaticTextLabel.cpp \
+    $$PWD/../SwipeGesture.cpp \
+    $$PWD/../SystemBus.cpp \
+    $$PWD/../SystemdUnitWatcher.cpp \
+    $$PWD/../Theme.cpp \
+    $$PWD/../TileGrid.cpp \
+    $$PWD/../ToggleButton.cpp \
+    $$PWD/../Trace.cpp \
+    $$PWD/../Weather.cpp \
+    $$PWD/../WeatherCache.cpp \
+    $$PWD/../WeatherSnapshot.cpp \
+    $$PWD/../WifiReader.cpp
+
+HEADERS += \
+    $$PWD/../CommandStats.h \
+    $$PWD/../ControlRegistry.h \
+    $$PWD/../DetailView.h \
+    $$PWD/../DeviceModel.h \
+    $$PWD/../DeviceRegistry.h \
+    $$PWD/../DeviceTileDelegate.h \
+    $$PWD/../HomeScreen.h \
+    $$PWD/../IconCache.h \
+    $$PWD/../IdleMonitor.h \
+    $$PWD/../MinuteClock.h \
+    $$PWD/../NetworkControls.h \
+    $$PWD/../NetworkManagerWatcher.h \
+    $$PWD/../PanelSnapshot.h \
+    $$PWD/../ProbeEngine.h \
+    $$PWD/../ProbeScheduler.h \
+    $$PWD/../SecurityCollectors.h \
+    $$PWD/../SecurityControls.h \
+    $$PWD/../SocketTable.h \
+    $$PWD/../StallWatchdog.h \
+    $$PWD/../StaticTextLabel.h \
+    $$PWD/../SwipeGesture.h \
+    $$PWD/../SystemBus.h \
+    $$PWD/../SystemdUnitWatcher.h \
+    $$PWD/../Theme.h \
+    $$PWD/../TileGrid.h \
+    $$PWD/../ToggleButton.h \
+    $$PWD/../Trace.h \
+    $$PWD/../Weather.h \
+    $$PWD/../WeatherCache.h \
+    $$PWD/../WeatherSnapshot.h \
+    $$PWD/../WifiReader.h
+
+DISTFILES += \
+    fixtures/nmcli-wifi.txt \
+    fixtures/open-meteo.json \
+    fixtures/proc-net-tcp.txt \
+    fixtures/ss-tuln.txt \
+    fixtures/weather.txt
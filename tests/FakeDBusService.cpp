@@ -0,0 +1,137 @@
+#include "FakeDBusService.h"
+
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusVariant>
+
+namespace {
+
+const QString PropertiesInterface = "org.freedesktop.DBus.Properties";
+
+} // namespace
+
+FakeDBusService::FakeDBusService(const QString &service, const QString &rootPath, QObject *parent)
+    : QDBusVirtualObject(parent),
+    service(service),
+    rootPath(rootPath),
+    connection(QDBusConnection::connectToBus(QDBusConnection::SessionBus, "fake-" + service))
+{
+    if (connection.isConnected())
+    {
+        connection.registerVirtualObject(rootPath, this, QDBusConnection::SubPath);
+    }
+}
+
+// Destructor
+FakeDBusService::~FakeDBusService()
+{
+    unregisterService();
+    connection.unregisterObject(rootPath);
+    QDBusConnection::disconnectFromBus("fake-" + service);
+}
+
+bool FakeDBusService::isConnected() const
+{
+    return connection.isConnected();
+}
+
+bool FakeDBusService::registerService()
+{
+    return connection.registerService(service);
+}
+
+void FakeDBusService::unregisterService()
+{
+    connection.unregisterService(service);
+}
+
+void FakeDBusService::setProperties(const QString &path, const QString &interface, const QVariantMap &properties)
+{
+    objects[path][interface] = properties;
+}
+
+void FakeDBusService::setProperty(const QString &path, const QString &interface, const QString &name, const QVariant &value)
+{
+    objects[path][interface].insert(name, value);
+
+    QVariantMap changed;
+    changed.insert(name, value);
+    emitSignal(path, PropertiesInterface, "PropertiesChanged",
+               QVariantList() << interface << changed << QStringList());
+}
+
+void FakeDBusService::setMethod(const QString &interface, const QString &member, const Method &method)
+{
+    errors.remove(interface + '.' + member);
+    methods.insert(interface + '.' + member, method);
+}
+
+void FakeDBusService::setMethodError(const QString &interface, const QString &member, const QString &errorName)
+{
+    errors.insert(interface + '.' + member, errorName);
+}
+
+void FakeDBusService::emitSignal(const QString &path, const QString &interface, const QString &name, const QVariantList &arguments)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(path, interface, name);
+    signal.setArguments(arguments);
+    connection.send(signal);
+}
+
+QStringList FakeDBusService::calls() const
+{
+    return received;
+}
+
+bool FakeDBusService::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage)
+    {
+        return false;
+    }
+
+    const QString key = message.interface() + '.' + message.member();
+    received.append(key);
+
+    const QList<QVariant> arguments = message.arguments();
+    if (message.interface() == PropertiesInterface && message.member() == "GetAll")
+    {
+        const QVariantMap properties = objects.value(message.path()).value(arguments.value(0).toString());
+        connection.send(message.createReply(QVariant(properties)));
+        return true;
+    }
+    if (message.interface() == PropertiesInterface && message.member() == "Get")
+    {
+        const QVariantMap properties = objects.value(message.path()).value(arguments.value(0).toString());
+        const QString name = arguments.value(1).toString();
+        if (!properties.contains(name))
+        {
+            connection.send(message.createErrorReply(QDBusError::UnknownProperty, "No property " + name));
+            return true;
+        }
+        connection.send(message.createReply(QVariant::fromValue(QDBusVariant(properties.value(name)))));
+        return true;
+    }
+
+    auto error = errors.constFind(key);
+    if (error != errors.constEnd())
+    {
+        connection.send(message.createErrorReply(*error, "Failing " + key + " on purpose"));
+        return true;
+    }
+
+    auto it = methods.constFind(key);
+    if (it == methods.constEnd())
+    {
+        connection.send(message.createErrorReply(QDBusError::UnknownMethod, "No method " + key));
+        return true;
+    }
+    connection.send(message.createReply((*it)(message)));
+    return true;
+}
+
+QString FakeDBusService::introspect(const QString &) const
+{
+    // Callers in the panel never introspect
+    return QString();
+}
@@ -0,0 +1,62 @@
+#ifndef FAKEDBUSSERVICE_H
+#define FAKEDBUSSERVICE_H
+
+#include <QDBusConnection>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QStringList>
+#include <QVariantMap>
+#include <functional>
+
+// Stand-in for a system service on the session bus. It has a connection of its
+// own, so the code under test reaches it through the bus daemon exactly like
+// the real service. Properties are kept per object path and interface and
+// served through org.freedesktop.DBus.Properties. Changing one emits
+// PropertiesChanged; other methods answer through handlers set by the test.
+class FakeDBusService : public QDBusVirtualObject
+{
+    Q_OBJECT
+
+public:
+    using Method = std::function<QVariantList(const QDBusMessage &call)>;
+
+    // Objects are served from rootPath down, the bus name is only claimed by registerService()
+    FakeDBusService(const QString &service, const QString &rootPath, QObject *parent = nullptr);
+    ~FakeDBusService();
+
+    bool isConnected() const;
+
+    // Claim or drop the bus name, like the daemon starting or stopping
+    bool registerService();
+    void unregisterService();
+
+    // Initial state, no signal is sent
+    void setProperties(const QString &path, const QString &interface, const QVariantMap &properties);
+
+    // Change one property and send PropertiesChanged for it
+    void setProperty(const QString &path, const QString &interface, const QString &name, const QVariant &value);
+
+    void setMethod(const QString &interface, const QString &member, const Method &method);
+
+    // Answer calls of a method with a D-Bus error until setMethod() is called for it
+    void setMethodError(const QString &interface, const QString &member, const QString &errorName);
+    void emitSignal(const QString &path, const QString &interface, const QString &name, const QVariantList &arguments);
+
+    // "interface.member" of every method call received, oldest first
+    QStringList calls() const;
+
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+    QString introspect(const QString &path) const override;
+
+private:
+    const QString service;
+    const QString rootPath;
+    QDBusConnection connection;
+
+    QHash<QString, QHash<QString, QVariantMap>> objects;
+    QHash<QString, Method> methods;
+    QHash<QString, QString> errors;
+    QStringList received;
+};
+
+#endif // FAKEDBUSSERVICE_H
@@ -0,0 +1,393 @@
+#include "DeviceModel.h"
+#include "DeviceRegistry.h"
+#include "NetworkManagerWatcher.h"
+#include "SystemdUnitWatcher.h"
+#include "FakeDBusService.h"
+
+#include <QCoreApplication>
+#include <QDBusObjectPath>
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace {
+
+const QString NetworkManagerService = "org.freedesktop.NetworkManager";
+const QString ManagerPath = "/org/freedesktop/NetworkManager";
+const QString DevicePath = "/org/freedesktop/NetworkManager/Devices/3";
+const QString HomeAccessPoint = "/org/freedesktop/NetworkManager/AccessPoint/7";
+const QString GuestAccessPoint = "/org/freedesktop/NetworkManager/AccessPoint/8";
+
+const QString SystemdService = "org.freedesktop.systemd1";
+const QString SystemdPath = "/org/freedesktop/systemd1";
+const QString UfwUnitPath = "/org/freedesktop/systemd1/unit/ufw_2eservice";
+const QString UnitInterface = "org.freedesktop.systemd1.Unit";
+
+} // namespace
+
+// The D-Bus watchers are tested against stand-in services on the session bus,
+// so they run without root, NetworkManager or a Wi-Fi adapter. Those tests are
+// skipped when there is no session bus or the service name is already taken.
+class HomeScreenTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void networkManagerWatcher();
+    void systemdUnitWatcher();
+    void systemdUnitWatcherErrors();
+    void deviceModelRooms();
+    void deviceUpdateBatching();
+
+private:
+    // A NetworkManager with one Wi-Fi device associated to the "Home" access point
+    static void populateNetworkManager(FakeDBusService *networkManager);
+};
+
+void HomeScreenTests::populateNetworkManager(FakeDBusService *networkManager)
+{
+    networkManager->setProperties(ManagerPath, "org.freedesktop.NetworkManager", {
+        {"WirelessEnabled", true},
+        {"Devices", QVariant::fromValue(QList<QDBusObjectPath>() << QDBusObjectPath(DevicePath))}
+    });
+    networkManager->setProperties(DevicePath, "org.freedesktop.NetworkManager.Device", {
+        {"DeviceType", 2u},
+        {"Interface", "wlan0"}
+    });
+    networkManager->setProperties(DevicePath, "org.freedesktop.NetworkManager.Device.Wireless", {
+        {"Bitrate", 144000u},
+        {"ActiveAccessPoint", QVariant::fromValue(QDBusObjectPath(HomeAccessPoint))}
+    });
+    networkManager->setProperties(HomeAccessPoint, "org.freedesktop.NetworkManager.AccessPoint", {
+        {"Ssid", QByteArray("Home")},
+        {"HwAddress", "AA:BB:CC:DD:EE:01"},
+        {"Frequency", 5180u},
+        {"Strength", QVariant::fromValue(uchar(70))},
+        {"Mode", 2u}
+    });
+    networkManager->setProperties(GuestAccessPoint, "org.freedesktop.NetworkManager.AccessPoint", {
+        {"Ssid", QByteArray("Guest")},
+        {"HwAddress", "AA:BB:CC:DD:EE:02"},
+        {"Frequency", 2437u},
+        {"Strength", QVariant::fromValue(uchar(45))},
+        {"Mode", 2u}
+    });
+}
+
+void HomeScreenTests::networkManagerWatcher()
+{
+    if (!QDBusConnection::sessionBus().isConnected())
+    {
+        QSKIP("No session bus");
+    }
+
+    FakeDBusService networkManager(NetworkManagerService, "/org/freedesktop/NetworkManager");
+    populateNetworkManager(&networkManager);
+    if (!networkManager.registerService())
+    {
+        QSKIP("org.freedesktop.NetworkManager is already on the session bus");
+    }
+
+    NetworkManagerWatcher watcher(QDBusConnection::sessionBus());
+    QSignalSpy watching(&watcher, &NetworkManagerWatcher::watchingChanged);
+    QVERIFY(watcher.start());
+
+    // start() only asks, the answer arrives from the event loop
+    QVERIFY(!watcher.isWatching());
+    QTRY_VERIFY(watcher.isWatching());
+    QTRY_COMPARE(watcher.link().ssid, QString("Home"));
+    QCOMPARE(watcher.wirelessEnabled(), true);
+    QCOMPARE(watcher.link().device, QString("wlan0"));
+    QCOMPARE(watcher.link().channel, 36);
+    QTRY_COMPARE(watcher.link().rateMbps, 144);
+    QCOMPARE(watcher.link().signal, 70);
+
+    // Radio switched off and on again
+    QSignalSpy radio(&watcher, &NetworkManagerWatcher::wirelessEnabledChanged);
+    networkManager.setProperty(ManagerPath, "org.freedesktop.NetworkManager", "WirelessEnabled", false);
+    QTRY_COMPARE(watcher.wirelessEnabled(), false);
+    networkManager.setProperty(ManagerPath, "org.freedesktop.NetworkManager", "WirelessEnabled", true);
+    QTRY_COMPARE(watcher.wirelessEnabled(), true);
+    QCOMPARE(radio.count(), 2);
+
+    // The active access point changes its own properties
+    networkManager.setProperty(HomeAccessPoint, "org.freedesktop.NetworkManager.AccessPoint",
+                               "Strength", QVariant::fromValue(uchar(40)));
+    QTRY_COMPARE(watcher.link().signal, 40);
+
+    // Roaming to another access point, changes of the old one are no longer followed
+    networkManager.setProperty(DevicePath, "org.freedesktop.NetworkManager.Device.Wireless",
+                               "ActiveAccessPoint", QVariant::fromValue(QDBusObjectPath(GuestAccessPoint)));
+    QTRY_COMPARE(watcher.link().ssid, QString("Guest"));
+    QCOMPARE(watcher.link().channel, 6);
+    networkManager.setProperty(HomeAccessPoint, "org.freedesktop.NetworkManager.AccessPoint",
+                               "Strength", QVariant::fromValue(uchar(90)));
+    QTest::qWait(100);
+    QCOMPARE(watcher.link().signal, 45);
+
+    // Disconnected
+    networkManager.setProperty(DevicePath, "org.freedesktop.NetworkManager.Device.Wireless",
+                               "ActiveAccessPoint", QVariant::fromValue(QDBusObjectPath("/")));
+    QTRY_COMPARE(watcher.link().connected, false);
+
+    // NetworkManager stops: watching ends so the panel can poll instead
+    networkManager.unregisterService();
+    QTRY_VERIFY(!watcher.isWatching());
+    QCOMPARE(watching.last().at(0).toBool(), false);
+
+    // ...and comes back: everything is read again and followed from then on
+    populateNetworkManager(&networkManager);
+    QVERIFY(networkManager.registerService());
+    QTRY_VERIFY(watcher.isWatching());
+    QTRY_COMPARE(watcher.link().ssid, QString("Home"));
+    networkManager.setProperty(ManagerPath, "org.freedesktop.NetworkManager", "WirelessEnabled", false);
+    QTRY_COMPARE(watcher.wirelessEnabled(), false);
+}
+
+void HomeScreenTests::systemdUnitWatcher()
+{
+    if (!QDBusConnection::sessionBus().isConnected())
+    {
+        QSKIP("No session bus");
+    }
+
+    // A systemd that knows one unit, ufw.service, currently stopped
+    FakeDBusService systemd(SystemdService, SystemdPath);
+    systemd.setProperties(UfwUnitPath, UnitInterface, {
+        {"Id", "ufw.service"},
+        {"ActiveState", "inactive"}
+    });
+    systemd.setMethod("org.freedesktop.systemd1.Manager", "Subscribe", [](const QDBusMessage &) {
+        return QVariantList();
+    });
+    QString loadedUnit;
+    systemd.setMethod("org.freedesktop.systemd1.Manager", "LoadUnit", [&loadedUnit](const QDBusMessage &call) {
+        loadedUnit = call.arguments().value(0).toString();
+        return QVariantList() << QVariant::fromValue(QDBusObjectPath(UfwUnitPath));
+    });
+    if (!systemd.registerService())
+    {
+        QSKIP("org.freedesktop.systemd1 is already on the session bus");
+    }
+
+    SystemdUnitWatcher watcher("ufw.service", QDBusConnection::sessionBus());
+    QSignalSpy changes(&watcher, &SystemdUnitWatcher::activeStateChanged);
+    QSignalSpy watching(&watcher, &SystemdUnitWatcher::watchingChanged);
+    QVERIFY(watcher.start());
+
+    // start() only asks, watching begins once the state has been read
+    QVERIFY(!watcher.isWatching());
+    QTRY_VERIFY(watcher.isWatching());
+    QCOMPARE(watching.count(), 1);
+
+    // Subscribed first, then the unit is loaded and its state read
+    QCOMPARE(watcher.activeState(), QString("inactive"));
+    QCOMPARE(watcher.isActive(), false);
+    QCOMPARE(loadedUnit, QString("ufw.service"));
+    const QStringList calls = systemd.calls();
+    QVERIFY(calls.indexOf("org.freedesktop.systemd1.Manager.Subscribe") >= 0);
+    QVERIFY(calls.indexOf("org.freedesktop.systemd1.Manager.Subscribe") <
+            calls.indexOf("org.freedesktop.systemd1.Manager.LoadUnit"));
+
+    // The firewall is enabled: systemd passes through activating
+    systemd.setProperty(UfwUnitPath, UnitInterface, "ActiveState", "activating");
+    QTRY_COMPARE(watcher.activeState(), QString("activating"));
+    QCOMPARE(watcher.isActive(), false);
+    systemd.setProperty(UfwUnitPath, UnitInterface, "ActiveState", "active");
+    QTRY_VERIFY(watcher.isActive());
+
+    // Changes of other interfaces and other properties are ignored
+    systemd.setProperty(UfwUnitPath, "org.freedesktop.systemd1.Service", "ActiveState", "failed");
+    systemd.setProperty(UfwUnitPath, UnitInterface, "SubState", "exited");
+    QTest::qWait(100);
+    QCOMPARE(watcher.activeState(), QString("active"));
+
+    // Only invalidated, the watcher fetches the value itself
+    systemd.setProperties(UfwUnitPath, UnitInterface, {
+        {"Id", "ufw.service"},
+        {"ActiveState", "inactive"}
+    });
+    systemd.emitSignal(UfwUnitPath, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                       QVariantList() << UnitInterface << QVariantMap() << QStringList("ActiveState"));
+    QTRY_COMPARE(watcher.activeState(), QString("inactive"));
+
+    QCOMPARE(changes.count(), 4);
+}
+
+void HomeScreenTests::systemdUnitWatcherErrors()
+{
+    if (!QDBusConnection::sessionBus().isConnected())
+    {
+        QSKIP("No session bus");
+    }
+
+    // A systemd that cannot load ufw.service
+    FakeDBusService systemd(SystemdService, SystemdPath);
+    systemd.setProperties(UfwUnitPath, UnitInterface, {
+        {"Id", "ufw.service"},
+        {"ActiveState", "active"}
+    });
+    systemd.setMethod("org.freedesktop.systemd1.Manager", "Subscribe", [](const QDBusMessage &) {
+        return QVariantList();
+    });
+    systemd.setMethodError("org.freedesktop.systemd1.Manager", "LoadUnit", "org.freedesktop.systemd1.NoSuchUnit");
+    if (!systemd.registerService())
+    {
+        QSKIP("org.freedesktop.systemd1 is already on the session bus");
+    }
+
+    SystemdUnitWatcher watcher("ufw.service", QDBusConnection::sessionBus());
+    QSignalSpy watching(&watcher, &SystemdUnitWatcher::watchingChanged);
+    QVERIFY(watcher.start());
+
+    // The failed load leaves the watcher not watching, so the caller keeps polling
+    QTRY_VERIFY(systemd.calls().contains("org.freedesktop.systemd1.Manager.LoadUnit"));
+    QTest::qWait(100);
+    QVERIFY(!watcher.isWatching());
+    QCOMPARE(watcher.activeState(), QString());
+    QCOMPARE(watching.count(), 0);
+
+    // systemd restarts and can load the unit now, the watcher picks it up
+    systemd.unregisterService();
+    systemd.setMethod("org.freedesktop.systemd1.Manager", "LoadUnit", [](const QDBusMessage &) {
+        return QVariantList() << QVariant::fromValue(QDBusObjectPath(UfwUnitPath));
+    });
+    QVERIFY(systemd.registerService());
+    QTRY_VERIFY(watcher.isWatching());
+    QVERIFY(watcher.isActive());
+    QCOMPARE(watching.count(), 1);
+
+    // The state can no longer be read: watching ends and nothing stale is reported
+    systemd.setProperties(UfwUnitPath, UnitInterface, {
+        {"Id", "ufw.service"}
+    });
+    systemd.emitSignal(UfwUnitPath, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                       QVariantList() << UnitInterface << QVariantMap() << QStringList("ActiveState"));
+    QTRY_VERIFY(!watcher.isWatching());
+    QCOMPARE(watching.count(), 2);
+    QCOMPARE(watching.last().at(0).toBool(), false);
+    QCOMPARE(watcher.activeState(), QString());
+
+    // Readable again after a restart, then systemd leaves the bus for good
+    systemd.setProperties(UfwUnitPath, UnitInterface, {
+        {"Id", "ufw.service"},
+        {"ActiveState", "inactive"}
+    });
+    systemd.unregisterService();
+    QVERIFY(systemd.registerService());
+    QTRY_VERIFY(watcher.isWatching());
+    QCOMPARE(watcher.activeState(), QString("inactive"));
+    systemd.unregisterService();
+    QTRY_VERIFY(!watcher.isWatching());
+}
+
+void HomeScreenTests::deviceModelRooms()
+{
+    DeviceRegistry registry;
+    registry.add(1, "Ceiling", DeviceRegistry::Light, "Bedroom", 1);
+    registry.add(2, "Heater", DeviceRegistry::Plug, "Bedroom", 0);
+    registry.add(3, "Hall", DeviceRegistry::Light, "Hallway", 0);
+
+    // An empty room is the whole house
+    DeviceModel everything(&registry, QString());
+    QCOMPARE(everything.rowCount(), 3);
+
+    DeviceModel bedroom(&registry, "Bedroom");
+    QCOMPARE(bedroom.rowCount(), 2);
+    QCOMPARE(bedroom.data(bedroom.index(1), Qt::DisplayRole).toString(), QString("Heater"));
+
+    // A room nobody has devices in is empty, and looking it up adds no room
+    DeviceModel garage(&registry, "Garage");
+    QCOMPARE(garage.rowCount(), 0);
+    QCOMPARE(registry.findRoom("Garage"), -1);
+
+    // ...until its first device turns up
+    registry.add(4, "Door", DeviceRegistry::Switch, "Garage", 0);
+    QCOMPARE(garage.rowCount(), 1);
+    QCOMPARE(garage.registryRow(0), registry.row(4));
+    QCOMPARE(bedroom.rowCount(), 2);
+    QCOMPARE(everything.rowCount(), 4);
+}
+
+void HomeScreenTests::deviceUpdateBatching()
+{
+    // Registry rows are the ids, even ones in the bedroom and odd ones in the kitchen
+    DeviceRegistry registry;
+    for (quint32 id = 0; id < 100; ++id)
+    {
+        registry.add(id, QString("Light %1").arg(id), DeviceRegistry::Light, id % 2 ? "Kitchen" : "Bedroom", 0);
+    }
+    DeviceModel bedroom(&registry, "Bedroom");
+    DeviceModel kitchen(&registry, "Kitchen");
+
+    QSignalSpy ranges(&registry, &DeviceRegistry::rowsChanged);
+    QSignalSpy bedroomChanges(&bedroom, &QAbstractItemModel::dataChanged);
+    QSignalSpy kitchenChanges(&kitchen, &QAbstractItemModel::dataChanged);
+
+    // Scattered and repeated changes are readable at once but not announced yet
+    for (quint32 id : {68u, 3u, 90u, 35u, 2u, 3u})
+    {
+        registry.setState(id, 1);
+    }
+    QCOMPARE(registry.state(registry.row(68)), 1);
+    QCOMPARE(ranges.count(), 0);
+
+    // Rows at most 32 apart share a range: 2-3-35 is one, 68 is 33 past 35 and starts the next
+    registry.flush();
+    QCOMPARE(ranges.count(), 2);
+    QCOMPARE(ranges.at(0), QVariantList() << 2 << 35);
+    QCOMPARE(ranges.at(1), QVariantList() << 68 << 90);
+
+    // Each range is a single dataChanged over the model rows inside it
+    QCOMPARE(bedroomChanges.count(), 2);
+    QCOMPARE(bedroomChanges.at(0).at(0).value<QModelIndex>().row(), 1);   // registry row 2
+    QCOMPARE(bedroomChanges.at(0).at(1).value<QModelIndex>().row(), 17);  // registry row 34
+    QCOMPARE(bedroomChanges.at(1).at(0).value<QModelIndex>().row(), 34);  // registry row 68
+    QCOMPARE(bedroomChanges.at(1).at(1).value<QModelIndex>().row(), 45);  // registry row 90
+    QCOMPARE(kitchenChanges.count(), 2);
+    QCOMPARE(kitchenChanges.at(0).at(0).value<QModelIndex>().row(), 1);   // registry row 3
+    QCOMPARE(kitchenChanges.at(0).at(1).value<QModelIndex>().row(), 17);  // registry row 35
+    QCOMPARE(kitchenChanges.at(1).at(0).value<QModelIndex>().row(), 34);  // registry row 69
+    QCOMPARE(kitchenChanges.at(1).at(1).value<QModelIndex>().row(), 44);  // registry row 89
+
+    // Nothing queued, nothing announced
+    registry.flush();
+    QCOMPARE(ranges.count(), 2);
+
+    // A range without rows of a room leaves that model alone
+    registry.setState(50, 1);
+    registry.flush();
+    QCOMPARE(ranges.last(), QVariantList() << 50 << 50);
+    QCOMPARE(bedroomChanges.count(), 3);
+    QCOMPARE(kitchenChanges.count(), 2);
+
+    // A receiver changing a row of the batch being announced queues it for the next flush
+    bool requeued = false;
+    connect(&registry, &DeviceRegistry::rowsChanged, this, [&registry, &requeued]() {
+        if (!requeued)
+        {
+            requeued = true;
+            registry.setState(3, 0);
+        }
+    });
+    registry.setState(3, 1);
+    registry.setState(80, 1);
+    registry.flush();
+    QCOMPARE(ranges.count(), 5);
+    QCOMPARE(ranges.at(3), QVariantList() << 3 << 3);
+    QCOMPARE(ranges.at(4), QVariantList() << 80 << 80);
+    registry.flush();
+    QCOMPARE(ranges.count(), 6);
+    QCOMPARE(ranges.last(), QVariantList() << 3 << 3);
+    QCOMPARE(registry.state(registry.row(3)), 0);
+
+    // Without an explicit flush the changes of a frame go out together shortly after
+    registry.setState(10, 1);
+    registry.setState(12, 1);
+    QCOMPARE(ranges.count(), 6);
+    QTRY_COMPARE(ranges.count(), 7);
+    QCOMPARE(ranges.last(), QVariantList() << 10 << 12);
+}
+
+QTEST_GUILESS_MAIN(HomeScreenTests)
+
+#include "HomeScreenTests.moc"
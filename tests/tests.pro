@@ -0,0 +1,30 @@
+QT       += core dbus testlib
+QT       -= gui
+
+lessThan(QT_MAJOR_VERSION, 6): error("HomeScreen needs Qt 6, found Qt $$QT_VERSION")
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = homescreen-tests
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    FakeDBusService.cpp \
+    HomeScreenTests.cpp \
+    $$PWD/../DeviceModel.cpp \
+    $$PWD/../DeviceRegistry.cpp \
+    $$PWD/../NetworkManagerWatcher.cpp \
+    $$PWD/../SystemdUnitWatcher.cpp \
+    $$PWD/../Trace.cpp \
+    $$PWD/../WifiReader.cpp
+
+HEADERS += \
+    FakeDBusService.h \
+    $$PWD/../DeviceModel.h \
+    $$PWD/../DeviceRegistry.h \
+    $$PWD/../NetworkManagerWatcher.h \
+    $$PWD/../SystemdUnitWatcher.h \
+    $$PWD/../Trace.h \
+    $$PWD/../WifiReader.h